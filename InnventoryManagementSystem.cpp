@@ -9,9 +9,39 @@
 #include <cstdlib>
 #include <fstream>
 #include <map>
+#include <set>
+#include <unordered_set>
 #include <functional>
 #include <iterator>
 #include <sstream>
+#include <condition_variable>
+#include <deque>
+#include <cerrno>
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#ifdef __linux__
+#include <csignal>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif
+#ifdef ISHOP_USE_IO_URING
+#include <liburing.h>
+#endif
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <exception>
+#include <atomic>
+#include <unordered_map>
+#include <cstdint>
+#include <climits>
+#include <cstring>
+#include <chrono>
 
 class InsufficientStockException : public std::runtime_error {
 private:
@@ -50,504 +80,4599 @@ public:
         : std::runtime_error("File operation failed: " + operation + " on " + filename) {}
 };
 
-class Product {
-protected:
-    std::string productId;
-    std::string name;
-    std::string category;
-    double price;
-    int stock;
-    static int totalProducts;
-    
+class CorruptDataException : public std::runtime_error {
 public:
-    Product(const std::string& id, const std::string& n, const std::string& cat, 
-            double p, int s = 0)
-        : productId(id), name(n), category(cat), stock(s) {
-        if (p < 0) {
-            throw InvalidPriceException(p);
-        }
-        price = p;
-        totalProducts++;
-    }
+    CorruptDataException(const std::string& context, const std::string& problem)
+        : std::runtime_error("Corrupt " + context + ": " + problem) {}
+};
+
+class SocketException : public std::runtime_error {
+public:
+    SocketException(const std::string& operation)
+        : std::runtime_error("Socket operation failed: " + operation + ": " + strerror(errno)) {}
+};
+
+class IoBackend {
+private:
+#ifdef ISHOP_USE_IO_URING
+    struct io_uring ring;
+    bool ringReady;
     
-    virtual ~Product() {
-        totalProducts--;
+    ssize_t submit(bool isWrite, int fd, void* data, size_t size, off_t offset) {
+        struct io_uring_sqe* sqe = io_uring_get_sqe(&ring);
+        if (!sqe) {
+            return -EBUSY;
+        }
+        if (isWrite) {
+            io_uring_prep_write(sqe, fd, data, static_cast<unsigned>(size), offset);
+        } else {
+            io_uring_prep_read(sqe, fd, data, static_cast<unsigned>(size), offset);
+        }
+        io_uring_submit(&ring);
+        
+        struct io_uring_cqe* cqe;
+        int rc = io_uring_wait_cqe(&ring, &cqe);
+        if (rc < 0) {
+            return rc;
+        }
+        ssize_t result = cqe->res;
+        io_uring_cqe_seen(&ring, cqe);
+        return result;
     }
+#endif
     
-    virtual void display() const {
-        std::cout << "ID: " << productId 
-                  << " | Name: " << name 
-                  << " | Category: " << category
-                  << " | Price: Rs." << price 
-                  << " | Stock: " << stock;
+public:
+    IoBackend() {
+#ifdef ISHOP_USE_IO_URING
+        ringReady = io_uring_queue_init(8, &ring, 0) == 0;
+#endif
     }
     
-    virtual double calculateDiscountedPrice(double discount) const {
-        if (discount < 0 || discount > 100) {
-            throw InvalidDiscountException(discount);
+    ~IoBackend() {
+#ifdef ISHOP_USE_IO_URING
+        if (ringReady) {
+            io_uring_queue_exit(&ring);
         }
-        return price * (1 - discount / 100.0);
+#endif
     }
     
-    virtual std::string getType() const = 0;
-    
-    virtual std::string toCSV() const = 0;
-    virtual void fromCSV(const std::string& csvLine) = 0;
-    
-    std::string getId() const { return productId; }
-    std::string getName() const { return name; }
-    std::string getCategory() const { return category; }
-    double getPrice() const { return price; }
-    int getStock() const { return stock; }
+    IoBackend(const IoBackend&) = delete;
+    IoBackend& operator=(const IoBackend&) = delete;
     
-    void setPrice(double newPrice) {
-        if (newPrice < 0) {
-            throw InvalidPriceException(newPrice);
+    ssize_t readAt(int fd, char* data, size_t size, off_t offset) {
+#ifdef ISHOP_USE_IO_URING
+        if (ringReady) {
+            ssize_t n = submit(false, fd, data, size, offset);
+            return n < 0 ? (errno = static_cast<int>(-n), -1) : n;
         }
-        price = newPrice;
+#endif
+        ssize_t n;
+        do {
+            n = pread(fd, data, size, offset);
+        } while (n < 0 && errno == EINTR);
+        return n;
     }
     
-    void updateStock(int quantity) {
-        int newStock = stock + quantity;
-        if (newStock < 0) {
-            throw InsufficientStockException(name, -quantity, stock);
+    bool writeAll(int fd, const char* data, size_t size, off_t offset) {
+        while (size > 0) {
+            ssize_t n;
+#ifdef ISHOP_USE_IO_URING
+            if (ringReady) {
+                n = submit(true, fd, const_cast<char*>(data), size, offset);
+                if (n < 0) {
+                    errno = static_cast<int>(-n);
+                    n = -1;
+                }
+            } else
+#endif
+            n = pwrite(fd, data, size, offset);
+            
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            data += n;
+            size -= static_cast<size_t>(n);
+            offset += n;
         }
-        stock = newStock;
+        return true;
     }
+};
+
+class AsyncFileWriter {
+private:
+    std::string path;
+    std::string tempPath;
+    int fd;
+    IoBackend backend;
+    size_t bufferSize;
+    std::string buffers[2];
+    int active;
+    bool pending;
+    bool finished;
+    bool committed;
+    int error;
+    off_t offset;
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::thread ioThread;
     
-    static int getTotalProducts() {
-        return totalProducts;
+    void ioLoop() {
+        std::unique_lock<std::mutex> lock(mutex);
+        for (;;) {
+            ready.wait(lock, [this]() { return pending || finished; });
+            if (!pending) {
+                return;
+            }
+            
+            std::string& buffer = buffers[active ^ 1];
+            off_t at = offset;
+            lock.unlock();
+            bool ok = error == 0 && backend.writeAll(fd, buffer.data(), buffer.size(), at);
+            int writeError = ok ? 0 : errno;
+            lock.lock();
+            
+            offset += buffer.size();
+            buffer.clear();
+            if (!ok && error == 0) {
+                error = writeError ? writeError : EIO;
+            }
+            pending = false;
+            ready.notify_all();
+        }
     }
     
-    friend void displayProductDetails(const Product& p);
-};
-
-int Product::totalProducts = 0;
-
-std::vector<std::string> split(const std::string& str, char delimiter) {
-    std::vector<std::string> tokens;
-    std::stringstream ss(str);
-    std::string token;
+    void handOff() {
+        std::unique_lock<std::mutex> lock(mutex);
+        ready.wait(lock, [this]() { return !pending; });
+        active ^= 1;
+        pending = true;
+        ready.notify_all();
+    }
     
-    while (std::getline(ss, token, delimiter)) {
-        tokens.push_back(token);
+    void stopIoThread() {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            ready.wait(lock, [this]() { return !pending; });
+            finished = true;
+            ready.notify_all();
+        }
+        if (ioThread.joinable()) {
+            ioThread.join();
+        }
     }
     
-    return tokens;
-}
-
-class Clothing : public Product {
-private:
-    std::string size;
-    std::string color;
-    std::string material;
+    static std::string directoryOf(const std::string& file) {
+        size_t slash = file.rfind('/');
+        return slash == std::string::npos ? "." : file.substr(0, slash + 1);
+    }
     
 public:
-    Clothing(const std::string& id = "", const std::string& n = "", double p = 0, int s = 0,
-             const std::string& sz = "", const std::string& col = "", const std::string& mat = "")
-        : Product(id, n, "Clothing", p, s), size(sz), color(col), material(mat) {}
+    explicit AsyncFileWriter(const std::string& file, size_t capacity = 1 << 20)
+        : path(file), tempPath(file + ".tmp"), bufferSize(capacity), active(0),
+          pending(false), finished(false), committed(false), error(0), offset(0) {
+        fd = open(tempPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            throw FileIOException(path, "save");
+        }
+        buffers[0].reserve(bufferSize);
+        buffers[1].reserve(bufferSize);
+        ioThread = std::thread(&AsyncFileWriter::ioLoop, this);
+    }
     
-    void display() const override {
-        Product::display();
-        std::cout << " | Size: " << size 
-                  << " | Color: " << color 
-                  << " | Material: " << material;
+    ~AsyncFileWriter() {
+        stopIoThread();
+        if (!committed) {
+            close(fd);
+            unlink(tempPath.c_str());
+        }
     }
     
-    std::string getType() const override {
-        return "Clothing";
+    AsyncFileWriter(const AsyncFileWriter&) = delete;
+    AsyncFileWriter& operator=(const AsyncFileWriter&) = delete;
+    
+    void write(const std::string& data) {
+        buffers[active] += data;
+        if (buffers[active].size() >= bufferSize) {
+            handOff();
+        }
     }
     
-    std::string toCSV() const override {
-        std::stringstream ss;
-        ss << "Clothing," << productId << "," << name << "," << price << "," 
-           << stock << "," << size << "," << color << "," << material;
-        return ss.str();
+    void writeLine(const std::string& line) {
+        write(line);
+        write("\n");
     }
     
-    void fromCSV(const std::string& csvLine) override {
-        auto tokens = split(csvLine, ',');
-        if (tokens.size() >= 8 && tokens[0] == "Clothing") {
-            productId = tokens[1];
-            name = tokens[2];
-            price = std::stod(tokens[3]);
-            stock = std::stoi(tokens[4]);
-            size = tokens[5];
-            color = tokens[6];
-            material = tokens[7];
+    void commit() {
+        if (!buffers[active].empty()) {
+            handOff();
+        }
+        stopIoThread();
+        
+        bool ok = error == 0 && fsync(fd) == 0;
+        ok = close(fd) == 0 && ok;
+        committed = true;
+        if (!ok || std::rename(tempPath.c_str(), path.c_str()) != 0) {
+            unlink(tempPath.c_str());
+            throw FileIOException(path, "save");
+        }
+        
+        int dir = open(directoryOf(path).c_str(), O_RDONLY);
+        if (dir >= 0) {
+            fsync(dir);
+            close(dir);
         }
     }
-    
-    std::string getSize() const { return size; }
-    std::string getColor() const { return color; }
-    std::string getMaterial() const { return material; }
 };
 
-class Stationery : public Product {
+class AsyncFileReader {
 private:
-    std::string brand;
-    std::string itemType;
+    int fd;
+    IoBackend backend;
+    size_t chunkSize;
+    std::string buffers[2];
+    bool filled[2];
+    bool stopping;
+    int error;
+    int current;
+    size_t position;
+    std::string carry;
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::thread ioThread;
     
-public:
-    Stationery(const std::string& id = "", const std::string& n = "", double p = 0, int s = 0,
-               const std::string& br = "", const std::string& type = "")
-        : Product(id, n, "Stationery", p, s), brand(br), itemType(type) {}
+    void ioLoop() {
+        off_t offset = 0;
+        for (int index = 0; ; index ^= 1) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                ready.wait(lock, [this, index]() { return !filled[index] || stopping; });
+                if (stopping) {
+                    return;
+                }
+            }
+            
+            std::string& buffer = buffers[index];
+            buffer.resize(chunkSize);
+            ssize_t n = backend.readAt(fd, &buffer[0], chunkSize, offset);
+            int readError = n < 0 ? errno : 0;
+            buffer.resize(n > 0 ? static_cast<size_t>(n) : 0);
+            offset += n > 0 ? n : 0;
+            
+            std::lock_guard<std::mutex> lock(mutex);
+            if (readError) {
+                error = readError;
+            }
+            filled[index] = true;
+            ready.notify_all();
+            if (n <= 0) {
+                return;
+            }
+        }
+    }
     
-    void display() const override {
-        Product::display();
-        std::cout << " | Brand: " << brand 
-                  << " | Type: " << itemType;
+    bool nextBuffer() {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (position > 0 || filled[current]) {
+            filled[current] = false;
+            current ^= 1;
+            ready.notify_all();
+        }
+        ready.wait(lock, [this]() { return filled[current]; });
+        position = 0;
+        if (error) {
+            throw std::runtime_error("Read failed: " + std::string(strerror(error)));
+        }
+        return !buffers[current].empty();
     }
     
-    std::string getType() const override {
-        return "Stationery";
+public:
+    explicit AsyncFileReader(const std::string& file, size_t capacity = 1 << 20)
+        : chunkSize(capacity), stopping(false), error(0), current(0), position(0) {
+        filled[0] = filled[1] = false;
+        fd = open(file.c_str(), O_RDONLY);
+        if (fd >= 0) {
+            ioThread = std::thread(&AsyncFileReader::ioLoop, this);
+            int readError;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                ready.wait(lock, [this]() { return filled[0]; });
+                readError = error;
+            }
+            if (readError) {
+                ioThread.join();
+                close(fd);
+                throw FileIOException(file, "read (" + std::string(strerror(readError)) + ")");
+            }
+        }
     }
     
-    std::string toCSV() const override {
-        std::stringstream ss;
-        ss << "Stationery," << productId << "," << name << "," << price << "," 
-           << stock << "," << brand << "," << itemType;
-        return ss.str();
+    ~AsyncFileReader() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+            ready.notify_all();
+        }
+        if (ioThread.joinable()) {
+            ioThread.join();
+        }
+        if (fd >= 0) {
+            close(fd);
+        }
     }
     
-    void fromCSV(const std::string& csvLine) override {
-        auto tokens = split(csvLine, ',');
-        if (tokens.size() >= 7 && tokens[0] == "Stationery") {
-            productId = tokens[1];
-            name = tokens[2];
-            price = std::stod(tokens[3]);
-            stock = std::stoi(tokens[4]);
-            brand = tokens[5];
-            itemType = tokens[6];
+    AsyncFileReader(const AsyncFileReader&) = delete;
+    AsyncFileReader& operator=(const AsyncFileReader&) = delete;
+    
+    bool isOpen() const { return fd >= 0; }
+    
+    bool getline(std::string& line) {
+        if (fd < 0) {
+            return false;
+        }
+        
+        for (;;) {
+            const std::string& buffer = buffers[current];
+            size_t newline = buffer.find('\n', position);
+            if (newline != std::string::npos) {
+                line.assign(carry);
+                line.append(buffer, position, newline - position);
+                carry.clear();
+                position = newline + 1;
+                if (!line.empty() && line[line.size() - 1] == '\r') {
+                    line.erase(line.size() - 1);
+                }
+                return true;
+            }
+            
+            carry.append(buffer, position, std::string::npos);
+            position = buffer.size();
+            if (buffer.empty() || !nextBuffer()) {
+                if (carry.empty()) {
+                    return false;
+                }
+                line.swap(carry);
+                carry.clear();
+                return true;
+            }
         }
     }
 };
 
-class Accessory : public Product {
+class PersistenceService {
 private:
-    bool isElectronic;
-    std::string accessoryType;
+    struct Job {
+        std::string description;
+        std::function<void()> task;
+    };
     
-public:
-    Accessory(const std::string& id = "", const std::string& n = "", double p = 0, int s = 0,
-              bool electronic = false, const std::string& type = "")
-        : Product(id, n, "Accessory", p, s), 
-          isElectronic(electronic), accessoryType(type) {}
+    std::deque<Job> jobs;
+    bool busy;
+    bool stopping;
+    std::string status;
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::thread worker;
     
-    void display() const override {
-        Product::display();
-        std::cout << " | Type: " << accessoryType 
-                  << " | Electronic: " << (isElectronic ? "Yes" : "No");
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex);
+        for (;;) {
+            changed.wait(lock, [this]() { return !jobs.empty() || stopping; });
+            if (jobs.empty()) {
+                return;
+            }
+            
+            Job job = jobs.front();
+            jobs.pop_front();
+            busy = true;
+            lock.unlock();
+            
+            std::string result;
+            try {
+                job.task();
+                time_t now = time(nullptr);
+                char stamp[16];
+                strftime(stamp, sizeof(stamp), "%H:%M:%S", localtime(&now));
+                result = job.description + " completed at " + stamp;
+            } catch (const std::exception& e) {
+                result = job.description + " failed: " + e.what();
+            }
+            
+            lock.lock();
+            if (!job.description.empty()) {
+                status = result;
+            }
+            busy = false;
+            changed.notify_all();
+        }
     }
     
-    double calculateDiscountedPrice(double discount) const override {
-        double baseDiscount = discount;
-        if (!isElectronic) {
-            baseDiscount += 5;
+public:
+    PersistenceService() : busy(false), stopping(false) {
+        worker = std::thread(&PersistenceService::run, this);
+    }
+    
+    ~PersistenceService() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+            changed.notify_all();
         }
-        return Product::calculateDiscountedPrice(baseDiscount);
+        worker.join();
     }
     
-    std::string getType() const override {
-        return "Accessory";
+    PersistenceService(const PersistenceService&) = delete;
+    PersistenceService& operator=(const PersistenceService&) = delete;
+    
+    void submit(const std::string& description, std::function<void()> task) {
+        std::lock_guard<std::mutex> lock(mutex);
+        jobs.push_back(Job{description, task});
+        changed.notify_all();
     }
     
-    std::string toCSV() const override {
-        std::stringstream ss;
-        ss << "Accessory," << productId << "," << name << "," << price << "," 
-           << stock << "," << (isElectronic ? "1" : "0") << "," << accessoryType;
-        return ss.str();
+    void waitIdle() {
+        std::unique_lock<std::mutex> lock(mutex);
+        changed.wait(lock, [this]() { return jobs.empty() && !busy; });
     }
     
-    void fromCSV(const std::string& csvLine) override {
-        auto tokens = split(csvLine, ',');
-        if (tokens.size() >= 7 && tokens[0] == "Accessory") {
-            productId = tokens[1];
-            name = tokens[2];
-            price = std::stod(tokens[3]);
-            stock = std::stoi(tokens[4]);
-            isElectronic = (tokens[5] == "1");
-            accessoryType = tokens[6];
-        }
+    std::string getStatus() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return status;
     }
 };
 
+enum class StockEventType {
+    LowStock,
+    OutOfStock
+};
+
+struct StockEvent {
+    StockEventType type;
+    std::string store;
+    std::string productId;
+    std::string productName;
+    int stock;
+    int reorderPoint;
+    int leadTimeDays;
+    time_t timestamp;
+};
+
 template<typename T>
-class Inventory {
+class BoundedEventQueue {
 private:
-    std::vector<T> products;
-    std::string inventoryName;
-    
-public:
-    Inventory(const std::string& name) : inventoryName(name) {}
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T value;
+    };
     
-    void addProduct(T product) {
-        products.push_back(product);
-    }
+    std::unique_ptr<Cell[]> cells;
+    size_t mask;
+    std::atomic<size_t> enqueuePos;
+    std::atomic<size_t> dequeuePos;
+    std::atomic<size_t> dropped;
     
-    void removeProduct(const std::string& id) {
-        auto it = std::remove_if(products.begin(), products.end(),
-            [&id](const T& p) { return p->getId() == id; });
-        
-        if (it != products.end()) {
-            products.erase(it, products.end());
-            std::cout << "Product " << id << " removed successfully.\n";
-        } else {
-            std::cout << "Product not found.\n";
+public:
+    explicit BoundedEventQueue(size_t capacity)
+        : enqueuePos(0), dequeuePos(0), dropped(0) {
+        size_t size = 2;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        cells.reset(new Cell[size]);
+        mask = size - 1;
+        for (size_t i = 0; i < size; i++) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
         }
     }
     
-    T findProduct(const std::string& id) {
-        for (auto& p : products) {
-            if (p->getId() == id) {
-                return p;
+    BoundedEventQueue(const BoundedEventQueue&) = delete;
+    BoundedEventQueue& operator=(const BoundedEventQueue&) = delete;
+    
+    bool tryPush(T value) {
+        size_t pos = enqueuePos.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells[pos & mask];
+            size_t seq = cell.sequence.load(std::memory_order_acquire);
+            long diff = static_cast<long>(seq) - static_cast<long>(pos);
+            if (diff == 0) {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.value = std::move(value);
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            } else {
+                pos = enqueuePos.load(std::memory_order_relaxed);
             }
         }
-        return nullptr;
     }
     
-    void displayAll() const {
-        std::cout << "\n=== " << inventoryName << " Inventory ===\n";
-        if (products.empty()) {
-            std::cout << "No products in inventory.\n";
-            return;
-        }
-        
-        for (const auto& p : products) {
-            p->display();
-            std::cout << "\n";
+    bool tryPop(T& value) {
+        size_t pos = dequeuePos.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells[pos & mask];
+            size_t seq = cell.sequence.load(std::memory_order_acquire);
+            long diff = static_cast<long>(seq) - static_cast<long>(pos + 1);
+            if (diff == 0) {
+                if (dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    value = std::move(cell.value);
+                    cell.sequence.store(pos + mask + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = dequeuePos.load(std::memory_order_relaxed);
+            }
         }
     }
     
-    std::vector<T> filterProducts(std::function<bool(const T)> condition) {
-        std::vector<T> result;
-        std::copy_if(products.begin(), products.end(), 
+    size_t capacity() const { return mask + 1; }
+    size_t getDropped() const { return dropped.load(std::memory_order_relaxed); }
+};
+
+inline size_t stringHeapBytes(const std::string& value) {
+    static const size_t inlineCapacity = std::string().capacity();
+    return value.capacity() > inlineCapacity ? value.capacity() + 1 : 0;
+}
+
+template<typename Map>
+size_t hashMapBytes(const Map& map) {
+    return map.bucket_count() * sizeof(void*) +
+           map.size() * (sizeof(typename Map::value_type) + 2 * sizeof(void*));
+}
+
+struct ProductHandle {
+    uint32_t index;
+    uint32_t generation;
+    
+    ProductHandle() : index(UINT32_MAX), generation(0) {}
+    ProductHandle(uint32_t i, uint32_t g) : index(i), generation(g) {}
+    
+    bool isNull() const { return index == UINT32_MAX; }
+    uint64_t key() const { return (static_cast<uint64_t>(generation) << 32) | index; }
+    
+    bool operator==(const ProductHandle& other) const {
+        return index == other.index && generation == other.generation;
+    }
+};
+
+class EpochReclaimer {
+private:
+    static const size_t pageSize = 64;
+    static const size_t maxPages = 1024;
+    
+    struct ThreadSlot {
+        size_t index;
+        int depth;
+        
+        ThreadSlot() : index(EpochReclaimer::instance().claimSlot()), depth(0) {}
+        ~ThreadSlot() { EpochReclaimer::instance().releaseSlot(index); }
+    };
+    
+    std::atomic<unsigned long long> globalEpoch;
+    std::unique_ptr<std::atomic<unsigned long long>[]> pages[maxPages];
+    size_t pageCount;
+    std::atomic<size_t> retiredCount;
+    std::vector<size_t> freeSlots;
+    std::vector<std::pair<unsigned long long, std::function<void()>>> retired;
+    std::mutex mutex;
+    
+    EpochReclaimer() : globalEpoch(1), pageCount(0), retiredCount(0) {}
+    
+    std::atomic<unsigned long long>& pinned(size_t index) {
+        return pages[index / pageSize][index % pageSize];
+    }
+    
+    size_t claimSlot() {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (freeSlots.empty()) {
+            if (pageCount == maxPages) {
+                throw std::length_error("Too many threads holding product references");
+            }
+            pages[pageCount].reset(new std::atomic<unsigned long long>[pageSize]);
+            for (size_t i = pageSize; i-- > 0;) {
+                pages[pageCount][i].store(0);
+                freeSlots.push_back(pageCount * pageSize + i);
+            }
+            pageCount++;
+        }
+        size_t index = freeSlots.back();
+        freeSlots.pop_back();
+        return index;
+    }
+    
+    void releaseSlot(size_t index) {
+        pinned(index).store(0);
+        std::lock_guard<std::mutex> lock(mutex);
+        freeSlots.push_back(index);
+    }
+    
+    static ThreadSlot& localSlot() {
+        static thread_local ThreadSlot slot;
+        return slot;
+    }
+    
+public:
+    EpochReclaimer(const EpochReclaimer&) = delete;
+    EpochReclaimer& operator=(const EpochReclaimer&) = delete;
+    
+    ~EpochReclaimer() {
+        for (auto& entry : retired) {
+            entry.second();
+        }
+    }
+    
+    static EpochReclaimer& instance() {
+        static EpochReclaimer reclaimer;
+        return reclaimer;
+    }
+    
+    void enter() {
+        ThreadSlot& slot = localSlot();
+        if (slot.depth++ == 0) {
+            pinned(slot.index).store(globalEpoch.load());
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+        }
+    }
+    
+    void exit() {
+        ThreadSlot& slot = localSlot();
+        if (--slot.depth == 0) {
+            pinned(slot.index).store(0);
+            if (retiredCount.load() > 0) {
+                reclaim();
+            }
+        }
+    }
+    
+    void retire(std::function<void()> deleter) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            retired.emplace_back(globalEpoch.fetch_add(1), std::move(deleter));
+            retiredCount = retired.size();
+        }
+        reclaim();
+    }
+    
+    void reclaim() {
+        std::vector<std::function<void()>> ready;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            unsigned long long oldest = ULLONG_MAX;
+            for (size_t i = 0; i < pageCount * pageSize; i++) {
+                unsigned long long epoch = pinned(i).load();
+                if (epoch != 0 && epoch < oldest) {
+                    oldest = epoch;
+                }
+            }
+            
+            auto kept = std::stable_partition(retired.begin(), retired.end(),
+                [oldest](const std::pair<unsigned long long, std::function<void()>>& entry) {
+                    return entry.first >= oldest;
+                });
+            for (auto it = kept; it != retired.end(); ++it) {
+                ready.push_back(std::move(it->second));
+            }
+            retired.erase(kept, retired.end());
+            retiredCount = retired.size();
+        }
+        for (auto& deleter : ready) {
+            deleter();
+        }
+    }
+};
+
+class EpochGuard {
+public:
+    EpochGuard() { EpochReclaimer::instance().enter(); }
+    ~EpochGuard() { EpochReclaimer::instance().exit(); }
+    
+    EpochGuard(const EpochGuard&) = delete;
+    EpochGuard& operator=(const EpochGuard&) = delete;
+};
+
+template<typename T>
+struct ProductRecord {
+    ProductHandle handle;
+    unsigned revision;
+    std::string id;
+    std::string name;
+    std::string category;
+    double price;
+    int stock;
+    std::string details;
+    std::string csv;
+    
+    explicit ProductRecord(const T& p)
+        : handle(p->getHandle()), revision(p->getRevision()), id(p->getId()), name(p->getName()),
+          category(p->getCategory()), price(p->getPrice()), stock(p->getStock()),
+          csv(p->toCSV()) {
+        std::ostringstream os;
+        p->display(os);
+        details = os.str();
+    }
+};
+
+struct ShardState {
+    std::string name;
+    std::atomic<unsigned long long> epoch;
+    std::atomic<unsigned long long> drainedEpoch;
+    std::atomic<unsigned long long> writesBegun;
+    std::atomic<unsigned long long> writesInFlight[2];
+    
+    explicit ShardState(const std::string& storeName) 
+        : name(storeName), epoch(0), drainedEpoch(0), writesBegun(0) {
+        writesInFlight[0] = 0;
+        writesInFlight[1] = 0;
+    }
+    
+    // Caller holds the shard mutex. Writes that started before the switch finish before this
+    // returns; later writes keep running and preserve each product's state on first touch.
+    unsigned long long advanceEpoch() {
+        unsigned long long previous = epoch.load();
+        epoch.store(previous + 1);
+        while (writesInFlight[previous & 1].load() != 0) {
+            std::this_thread::yield();
+        }
+        drainedEpoch.store(previous + 1);
+        return previous + 1;
+    }
+};
+
+class Product {
+    friend class ProductSlotTable;
+    
+protected:
+    std::string productId;
+    std::string name;
+    std::string category;
+    std::atomic<double> price;
+    std::atomic<int> stock;
+    std::atomic<unsigned> revision;
+    std::atomic<ShardState*> shard;
+    std::atomic<Product*> relocatedTo;
+    std::atomic<int> reorderPoint;
+    std::atomic<int> leadTimeDays;
+    std::atomic<unsigned long long> preservedEpoch;
+    std::shared_ptr<const ProductRecord<Product*>> preserved;
+    std::mutex preserveMutex;
+    ProductHandle handle;
+    static std::atomic<int> totalProducts;
+    static std::atomic<BoundedEventQueue<StockEvent>*> stockEvents;
+    static const int relocatingStock = INT_MIN;
+    
+    class StockWriteGuard {
+    private:
+        ShardState* state;
+        unsigned long long epoch;
+        bool registered;
+        const StockWriteGuard* outer;
+        
+        static const StockWriteGuard*& innermost() {
+            static thread_local const StockWriteGuard* guard = nullptr;
+            return guard;
+        }
+        
+    public:
+        explicit StockWriteGuard(Product& product) 
+            : state(product.shard.load()), epoch(0), registered(false), outer(innermost()) {
+            if (!state) {
+                return;
+            }
+            if (outer && outer->state == state) {
+                epoch = outer->epoch;
+            } else {
+                for (;;) {
+                    epoch = state->epoch.load();
+                    state->writesInFlight[epoch & 1]++;
+                    if (state->epoch.load() == epoch) {
+                        break;
+                    }
+                    state->writesInFlight[epoch & 1]--;
+                }
+                registered = true;
+                state->writesBegun++;
+            }
+            
+            try {
+                product.preserveFor(epoch, *state);
+            } catch (...) {
+                if (registered) {
+                    state->writesInFlight[epoch & 1]--;
+                }
+                throw;
+            }
+            innermost() = this;
+        }
+        
+        ~StockWriteGuard() {
+            if (!state) {
+                return;
+            }
+            innermost() = outer;
+            if (registered) {
+                state->writesInFlight[epoch & 1]--;
+            }
+        }
+        
+        StockWriteGuard(const StockWriteGuard&) = delete;
+        StockWriteGuard& operator=(const StockWriteGuard&) = delete;
+    };
+    
+    void preserveFor(unsigned long long epoch, const ShardState& state) {
+        if (preservedEpoch.load() == epoch) {
+            return;
+        }
+        while (state.drainedEpoch.load() < epoch) {
+            std::this_thread::yield();
+        }
+        std::lock_guard<std::mutex> lock(preserveMutex);
+        if (preservedEpoch.load() != epoch) {
+            preserved = std::make_shared<const ProductRecord<Product*>>(this);
+            preservedEpoch.store(epoch);
+        }
+    }
+    
+    void publishStockEvent(StockEventType type, int currentStock, int point) const {
+        BoundedEventQueue<StockEvent>* queue = stockEvents.load(std::memory_order_acquire);
+        if (!queue) {
+            return;
+        }
+        ShardState* state = shard.load();
+        queue->tryPush(StockEvent{type, state ? state->name : std::string(), productId, name, 
+                                  currentStock, point, leadTimeDays.load(), time(nullptr)});
+    }
+    
+    void publishStockCrossing(int oldStock, int newStock) const {
+        int point = reorderPoint.load();
+        if (newStock == 0 && oldStock > 0) {
+            publishStockEvent(StockEventType::OutOfStock, newStock, point);
+        } else if (newStock <= point && oldStock > point) {
+            publishStockEvent(StockEventType::LowStock, newStock, point);
+        }
+    }
+    
+    std::string reorderCSV() const {
+        return "," + std::to_string(reorderPoint.load()) + "," + std::to_string(leadTimeDays.load());
+    }
+    
+    void reorderFromTokens(const std::vector<std::string>& tokens, size_t offset) {
+        if (tokens.size() >= offset + 2) {
+            reorderPoint = std::stoi(tokens[offset]);
+            leadTimeDays = std::stoi(tokens[offset + 1]);
+        }
+    }
+    
+public:
+    Product(const std::string& id, const std::string& n, const std::string& cat, 
+            double p, int s = 0)
+        : productId(id), name(n), category(cat), price(0), stock(s), revision(0), shard(nullptr),
+          relocatedTo(nullptr), reorderPoint(10), leadTimeDays(7), preservedEpoch(0) {
+        if (p < 0) {
+            throw InvalidPriceException(p);
+        }
+        price = p;
+        totalProducts++;
+    }
+    
+    Product(const Product& other)
+        : productId(other.productId), name(other.name), category(other.category),
+          price(other.price.load()), stock(other.getStock()), revision(other.revision.load()), 
+          shard(nullptr), relocatedTo(nullptr),
+          reorderPoint(other.reorderPoint.load()), leadTimeDays(other.leadTimeDays.load()), preservedEpoch(0) {
+        totalProducts++;
+    }
+    
+    virtual ~Product() {
+        totalProducts--;
+    }
+    
+    virtual void display(std::ostream& os = std::cout) const {
+        os << "ID: " << productId 
+           << " | Name: " << name 
+           << " | Category: " << category
+           << " | Price: Rs." << price 
+           << " | Stock: " << getStock();
+    }
+    
+    virtual double calculateDiscountedPrice(double discount) const {
+        if (discount < 0 || discount > 100) {
+            throw InvalidDiscountException(discount);
+        }
+        return price * (1 - discount / 100.0);
+    }
+    
+    virtual std::string getType() const = 0;
+    virtual Product* clone() const = 0;
+    virtual size_t objectBytes() const = 0;
+    
+    virtual size_t stringHeap() const {
+        return stringHeapBytes(productId) + stringHeapBytes(name) + stringHeapBytes(category);
+    }
+    
+    virtual std::string toCSV() const = 0;
+    virtual void fromCSV(const std::string& csvLine) = 0;
+    
+    std::string getId() const { return productId; }
+    std::string getName() const { return name; }
+    std::string getCategory() const { return category; }
+    double getPrice() const { return price; }
+    int getStock() const {
+        int current = stock.load();
+        return current != relocatingStock ? current : awaitRelocation()->getStock();
+    }
+    unsigned getRevision() const { return revision.load(); }
+    int getReorderPoint() const { return reorderPoint.load(); }
+    int getLeadTimeDays() const { return leadTimeDays.load(); }
+    ProductHandle getHandle() const { return handle; }
+    bool needsReorder() const { return getStock() <= getReorderPoint(); }
+    
+    void setPrice(double newPrice) {
+        if (newPrice < 0) {
+            throw InvalidPriceException(newPrice);
+        }
+        StockWriteGuard guard(*this);
+        price = newPrice;
+        revision++;
+    }
+    
+    void updateStock(int quantity) {
+        StockWriteGuard guard(*this);
+        for (;;) {
+            int current = stock.load();
+            if (current == relocatingStock) {
+                Product* target = awaitRelocation();
+                if (target != this) {
+                    target->updateStock(quantity);
+                    return;
+                }
+                continue;
+            }
+            
+            int newStock = current + quantity;
+            if (newStock < 0) {
+                throw InsufficientStockException(name, -quantity, current);
+            }
+            if (stock.compare_exchange_weak(current, newStock)) {
+                revision++;
+                publishStockCrossing(current, newStock);
+                return;
+            }
+        }
+    }
+    
+    Product* awaitRelocation() const {
+        for (;;) {
+            Product* target = relocatedTo.load();
+            if (target) {
+                return target;
+            }
+            if (stock.load() != relocatingStock) {
+                return const_cast<Product*>(this);
+            }
+            std::this_thread::yield();
+        }
+    }
+    
+    void relocateTo(Product* target) {
+        target->stock.store(relocatingStock);
+        target->shard.store(shard.load());
+        target->handle = handle;
+        relocatedTo.store(target);
+        int current = stock.exchange(relocatingStock);
+        target->revision.store(revision.load() + 1);
+        target->stock.store(current);
+    }
+    
+    void setReorderPolicy(int point, int leadTime) {
+        if (point < 0 || leadTime < 0) {
+            throw std::invalid_argument("Reorder point and lead time cannot be negative");
+        }
+        StockWriteGuard guard(*this);
+        leadTimeDays = leadTime;
+        int previousPoint = reorderPoint.exchange(point);
+        revision++;
+        
+        int current = getStock();
+        if (current > 0 && current <= point && current > previousPoint) {
+            publishStockEvent(StockEventType::LowStock, current, point);
+        }
+    }
+    
+    static void setStockEventQueue(BoundedEventQueue<StockEvent>* queue) {
+        stockEvents.store(queue, std::memory_order_release);
+    }
+    
+    static int getTotalProducts() {
+        return totalProducts;
+    }
+    
+    void attachToShard(ShardState* state) {
+        preservedEpoch.store(state ? state->epoch.load() : 0);
+        shard.store(state);
+    }
+    
+    // The state this product had before its first write in the given epoch, if it was written.
+    std::shared_ptr<const ProductRecord<Product*>> stateBefore(unsigned long long epoch) const {
+        return preservedEpoch.load() == epoch ? preserved : nullptr;
+    }
+    
+    friend void displayProductDetails(const Product& p);
+};
+
+std::atomic<int> Product::totalProducts(0);
+std::atomic<BoundedEventQueue<StockEvent>*> Product::stockEvents(nullptr);
+
+class ProductSlotTable {
+private:
+    static const uint32_t pageBits = 16;
+    static const uint32_t pageSize = 1u << pageBits;
+    static const uint32_t maxPages = 1024;
+    
+    struct Slot {
+        std::atomic<Product*> product;
+        std::atomic<uint32_t> generation;
+        
+        Slot() : product(nullptr), generation(1) {}
+    };
+    
+    std::unique_ptr<Slot[]> pages[maxPages];
+    std::atomic<Slot*> pageIndex[maxPages];
+    uint32_t slotCount;
+    std::vector<uint32_t> freeSlots;
+    std::mutex allocationMutex;
+    
+    Slot* slotAt(uint32_t index) const {
+        Slot* page = pageIndex[index >> pageBits].load(std::memory_order_acquire);
+        return page ? &page[index & (pageSize - 1)] : nullptr;
+    }
+    
+    ProductSlotTable() : slotCount(0) {
+        for (uint32_t i = 0; i < maxPages; i++) {
+            pageIndex[i].store(nullptr, std::memory_order_relaxed);
+        }
+    }
+    
+public:
+    ProductSlotTable(const ProductSlotTable&) = delete;
+    ProductSlotTable& operator=(const ProductSlotTable&) = delete;
+    
+    static ProductSlotTable& instance() {
+        static ProductSlotTable table;
+        return table;
+    }
+    
+    ProductHandle acquire(Product* product) {
+        std::lock_guard<std::mutex> lock(allocationMutex);
+        if (!product->handle.isNull()) {
+            return product->handle;
+        }
+        
+        uint32_t index;
+        if (!freeSlots.empty()) {
+            index = freeSlots.back();
+            freeSlots.pop_back();
+        } else {
+            if (slotCount == pageSize * maxPages) {
+                throw std::length_error("Product slot table is full");
+            }
+            index = slotCount++;
+            uint32_t page = index >> pageBits;
+            if (!pages[page]) {
+                pages[page].reset(new Slot[pageSize]);
+                pageIndex[page].store(pages[page].get(), std::memory_order_release);
+            }
+        }
+        
+        Slot* slot = slotAt(index);
+        slot->product.store(product, std::memory_order_release);
+        product->handle = ProductHandle(index, slot->generation.load(std::memory_order_relaxed));
+        return product->handle;
+    }
+    
+    Product* resolve(ProductHandle h) const {
+        if (h.isNull() || h.index >= pageSize * maxPages) {
+            return nullptr;
+        }
+        Slot* slot = slotAt(h.index);
+        if (!slot || slot->generation.load(std::memory_order_acquire) != h.generation) {
+            return nullptr;
+        }
+        Product* product = slot->product.load(std::memory_order_acquire);
+        if (slot->generation.load(std::memory_order_acquire) != h.generation) {
+            return nullptr;
+        }
+        return product;
+    }
+    
+    void release(ProductHandle h) {
+        Product* product = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(allocationMutex);
+            Slot* slot = resolve(h) ? slotAt(h.index) : nullptr;
+            if (!slot) {
+                return;
+            }
+            product = slot->product.load(std::memory_order_relaxed);
+            slot->generation.fetch_add(1, std::memory_order_acq_rel);
+            slot->product.store(nullptr, std::memory_order_release);
+            freeSlots.push_back(h.index);
+        }
+        EpochReclaimer::instance().retire([product]() { delete product; });
+    }
+    
+    void relocate(ProductHandle h, Product* moved) {
+        std::lock_guard<std::mutex> lock(allocationMutex);
+        Slot* slot = resolve(h) ? slotAt(h.index) : nullptr;
+        if (!slot) {
+            throw std::invalid_argument("Cannot relocate a stale product handle");
+        }
+        if (moved->handle.isNull()) {
+            moved->handle = h;
+        }
+        slot->product.store(moved, std::memory_order_release);
+    }
+    
+    size_t liveCount() {
+        std::lock_guard<std::mutex> lock(allocationMutex);
+        return slotCount - freeSlots.size();
+    }
+    
+    size_t memoryFootprint() {
+        std::lock_guard<std::mutex> lock(allocationMutex);
+        size_t allocatedPages = (slotCount + pageSize - 1) / pageSize;
+        return sizeof(*this) + allocatedPages * pageSize * sizeof(Slot) +
+               freeSlots.capacity() * sizeof(uint32_t);
+    }
+};
+
+std::vector<std::string> split(const std::string& str, char delimiter) {
+    std::vector<std::string> tokens;
+    std::stringstream ss(str);
+    std::string token;
+    
+    while (std::getline(ss, token, delimiter)) {
+        tokens.push_back(token);
+    }
+    
+    return tokens;
+}
+
+class Clothing : public Product {
+private:
+    std::string size;
+    std::string color;
+    std::string material;
+    
+public:
+    Clothing(const std::string& id = "", const std::string& n = "", double p = 0, int s = 0,
+             const std::string& sz = "", const std::string& col = "", const std::string& mat = "")
+        : Product(id, n, "Clothing", p, s), size(sz), color(col), material(mat) {}
+    
+    void display(std::ostream& os = std::cout) const override {
+        Product::display(os);
+        os << " | Size: " << size 
+           << " | Color: " << color 
+           << " | Material: " << material;
+    }
+    
+    std::string getType() const override {
+        return "Clothing";
+    }
+    
+    Product* clone() const override {
+        return new Clothing(*this);
+    }
+    
+    size_t objectBytes() const override {
+        return sizeof(*this);
+    }
+    
+    size_t stringHeap() const override {
+        return Product::stringHeap() + stringHeapBytes(size) + stringHeapBytes(color) + stringHeapBytes(material);
+    }
+    
+    std::string toCSV() const override {
+        std::stringstream ss;
+        ss << "Clothing," << productId << "," << name << "," << price << "," 
+           << getStock() << "," << size << "," << color << "," << material
+           << reorderCSV();
+        return ss.str();
+    }
+    
+    void fromCSV(const std::string& csvLine) override {
+        auto tokens = split(csvLine, ',');
+        if (tokens.size() >= 8 && tokens[0] == "Clothing") {
+            productId = tokens[1];
+            name = tokens[2];
+            price = std::stod(tokens[3]);
+            stock = std::stoi(tokens[4]);
+            size = tokens[5];
+            color = tokens[6];
+            material = tokens[7];
+            reorderFromTokens(tokens, 8);
+        }
+    }
+    
+    std::string getSize() const { return size; }
+    std::string getColor() const { return color; }
+    std::string getMaterial() const { return material; }
+};
+
+class Stationery : public Product {
+private:
+    std::string brand;
+    std::string itemType;
+    
+public:
+    Stationery(const std::string& id = "", const std::string& n = "", double p = 0, int s = 0,
+               const std::string& br = "", const std::string& type = "")
+        : Product(id, n, "Stationery", p, s), brand(br), itemType(type) {}
+    
+    void display(std::ostream& os = std::cout) const override {
+        Product::display(os);
+        os << " | Brand: " << brand 
+           << " | Type: " << itemType;
+    }
+    
+    std::string getType() const override {
+        return "Stationery";
+    }
+    
+    Product* clone() const override {
+        return new Stationery(*this);
+    }
+    
+    size_t objectBytes() const override {
+        return sizeof(*this);
+    }
+    
+    size_t stringHeap() const override {
+        return Product::stringHeap() + stringHeapBytes(brand) + stringHeapBytes(itemType);
+    }
+    
+    std::string toCSV() const override {
+        std::stringstream ss;
+        ss << "Stationery," << productId << "," << name << "," << price << "," 
+           << getStock() << "," << brand << "," << itemType
+           << reorderCSV();
+        return ss.str();
+    }
+    
+    void fromCSV(const std::string& csvLine) override {
+        auto tokens = split(csvLine, ',');
+        if (tokens.size() >= 7 && tokens[0] == "Stationery") {
+            productId = tokens[1];
+            name = tokens[2];
+            price = std::stod(tokens[3]);
+            stock = std::stoi(tokens[4]);
+            brand = tokens[5];
+            itemType = tokens[6];
+            reorderFromTokens(tokens, 7);
+        }
+    }
+};
+
+class Accessory : public Product {
+private:
+    bool isElectronic;
+    std::string accessoryType;
+    
+public:
+    Accessory(const std::string& id = "", const std::string& n = "", double p = 0, int s = 0,
+              bool electronic = false, const std::string& type = "")
+        : Product(id, n, "Accessory", p, s), 
+          isElectronic(electronic), accessoryType(type) {}
+    
+    void display(std::ostream& os = std::cout) const override {
+        Product::display(os);
+        os << " | Type: " << accessoryType 
+           << " | Electronic: " << (isElectronic ? "Yes" : "No");
+    }
+    
+    double calculateDiscountedPrice(double discount) const override {
+        double baseDiscount = discount;
+        if (!isElectronic) {
+            baseDiscount += 5;
+        }
+        return Product::calculateDiscountedPrice(baseDiscount);
+    }
+    
+    std::string getType() const override {
+        return "Accessory";
+    }
+    
+    Product* clone() const override {
+        return new Accessory(*this);
+    }
+    
+    size_t objectBytes() const override {
+        return sizeof(*this);
+    }
+    
+    size_t stringHeap() const override {
+        return Product::stringHeap() + stringHeapBytes(accessoryType);
+    }
+    
+    std::string toCSV() const override {
+        std::stringstream ss;
+        ss << "Accessory," << productId << "," << name << "," << price << "," 
+           << getStock() << "," << (isElectronic ? "1" : "0") << "," << accessoryType
+           << reorderCSV();
+        return ss.str();
+    }
+    
+    void fromCSV(const std::string& csvLine) override {
+        auto tokens = split(csvLine, ',');
+        if (tokens.size() >= 7 && tokens[0] == "Accessory") {
+            productId = tokens[1];
+            name = tokens[2];
+            price = std::stod(tokens[3]);
+            stock = std::stoi(tokens[4]);
+            isElectronic = (tokens[5] == "1");
+            accessoryType = tokens[6];
+            reorderFromTokens(tokens, 7);
+        }
+    }
+};
+
+template<typename Task>
+void runInParallel(size_t count, Task task) {
+    std::vector<std::thread> workers;
+    std::vector<std::exception_ptr> errors(count);
+    
+    for (size_t i = 0; i < count; i++) {
+        workers.emplace_back([&task, &errors, i]() {
+            try {
+                task(i);
+            } catch (...) {
+                errors[i] = std::current_exception();
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    for (const auto& error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+}
+
+template<typename T>
+class InventorySnapshot {
+public:
+    typedef std::shared_ptr<const ProductRecord<T>> RecordPtr;
+    
+private:
+    std::string inventoryName;
+    unsigned long long epoch;
+    unsigned long long structureVersion;
+    std::vector<RecordPtr> records;
+    
+public:
+    InventorySnapshot(const std::string& name, unsigned long long e, unsigned long long version,
+                      std::vector<RecordPtr> recs)
+        : inventoryName(name), epoch(e), structureVersion(version), records(std::move(recs)) {}
+    
+    const std::string& getName() const { return inventoryName; }
+    unsigned long long getEpoch() const { return epoch; }
+    unsigned long long getStructureVersion() const { return structureVersion; }
+    const std::vector<RecordPtr>& getRecords() const { return records; }
+    bool empty() const { return records.empty(); }
+    
+    int getTotalStock() const {
+        return std::accumulate(records.begin(), records.end(), 0,
+            [](int sum, const RecordPtr& r) { return sum + r->stock; });
+    }
+    
+    double getTotalValue() const {
+        return std::accumulate(records.begin(), records.end(), 0.0,
+            [](double sum, const RecordPtr& r) { return sum + (r->price * r->stock); });
+    }
+};
+
+template<typename T>
+class Inventory {
+private:
+    std::vector<T> products;
+    std::unordered_map<std::string, ProductHandle> idIndex;
+    std::string inventoryName;
+    mutable std::mutex shardMutex;
+    mutable ShardState shardState;
+    unsigned long long structureVersion;
+    mutable std::shared_ptr<const InventorySnapshot<T>> lastSnapshot;
+    bool loadFailed;
+    int stockCheckpoint;
+    
+    std::vector<typename InventorySnapshot<T>::RecordPtr> captureRecords(unsigned long long epoch) const {
+        std::unordered_map<uint64_t, typename InventorySnapshot<T>::RecordPtr> previous;
+        if (lastSnapshot) {
+            for (const auto& record : lastSnapshot->getRecords()) {
+                previous[record->handle.key()] = record;
+            }
+        }
+        
+        std::vector<typename InventorySnapshot<T>::RecordPtr> records;
+        records.reserve(products.size());
+        for (const auto& p : products) {
+            typename InventorySnapshot<T>::RecordPtr record = p->stateBefore(epoch);
+            if (!record) {
+                auto it = previous.find(p->getHandle().key());
+                if (it != previous.end() && it->second->revision == p->getRevision()) {
+                    record = it->second;
+                } else {
+                    record = std::make_shared<const ProductRecord<T>>(p);
+                }
+                auto before = p->stateBefore(epoch);
+                if (before) {
+                    record = before;
+                }
+            }
+            records.push_back(record);
+        }
+        return records;
+    }
+    
+    T findUnlocked(const std::string& id) const {
+        auto it = idIndex.find(id);
+        return it != idIndex.end() ? ProductSlotTable::instance().resolve(it->second) : nullptr;
+    }
+    
+    void insertUnlocked(T product) {
+        ProductHandle handle = ProductSlotTable::instance().acquire(product);
+        product->attachToShard(&shardState);
+        products.push_back(product);
+        idIndex.insert({product->getId(), handle});
+        structureVersion++;
+    }
+    
+    void releaseAllUnlocked() {
+        for (const auto& p : products) {
+            ProductSlotTable::instance().release(p->getHandle());
+        }
+        products.clear();
+        idIndex.clear();
+        structureVersion++;
+    }
+    
+public:
+    Inventory(const std::string& name) 
+        : inventoryName(name), shardState(name), structureVersion(0), loadFailed(false), 
+          stockCheckpoint(-1) {}
+    
+    ~Inventory() {
+        releaseAllUnlocked();
+    }
+    
+    Inventory(const Inventory&) = delete;
+    Inventory& operator=(const Inventory&) = delete;
+    
+    std::string getName() const { return inventoryName; }
+    
+    void addProduct(T product) {
+        std::lock_guard<std::mutex> lock(shardMutex);
+        insertUnlocked(product);
+    }
+    
+    void removeProduct(const std::string& id) {
+        std::lock_guard<std::mutex> lock(shardMutex);
+        auto it = std::remove_if(products.begin(), products.end(),
+            [&id](const T& p) { return p->getId() == id; });
+        
+        if (it != products.end()) {
+            for (auto removed = it; removed != products.end(); ++removed) {
+                ProductSlotTable::instance().release((*removed)->getHandle());
+            }
+            products.erase(it, products.end());
+            idIndex.erase(id);
+            structureVersion++;
+            std::cout << "Product " << id << " removed successfully.\n";
+        } else {
+            std::cout << "Product not found.\n";
+        }
+    }
+    
+    T findProduct(const std::string& id) {
+        std::lock_guard<std::mutex> lock(shardMutex);
+        return findUnlocked(id);
+    }
+    
+    std::shared_ptr<const InventorySnapshot<T>> snapshot() const {
+        std::lock_guard<std::mutex> lock(shardMutex);
+        unsigned long long begun = shardState.writesBegun.load();
+        if (lastSnapshot && lastSnapshot->getEpoch() == begun &&
+            lastSnapshot->getStructureVersion() == structureVersion) {
+            return lastSnapshot;
+        }
+        
+        unsigned long long epoch = shardState.advanceEpoch();
+        lastSnapshot = std::make_shared<const InventorySnapshot<T>>(
+            inventoryName, begun, structureVersion, captureRecords(epoch));
+        return lastSnapshot;
+    }
+    
+    void displayAll() const {
+        auto view = snapshot();
+        std::cout << "\n=== " << inventoryName << " Inventory ===\n";
+        if (view->empty()) {
+            std::cout << "No products in inventory.\n";
+            return;
+        }
+        
+        for (const auto& record : view->getRecords()) {
+            std::cout << record->details << "\n";
+        }
+    }
+    
+    std::vector<T> filterProducts(std::function<bool(const T)> condition) {
+        std::lock_guard<std::mutex> lock(shardMutex);
+        std::vector<T> result;
+        std::copy_if(products.begin(), products.end(), 
                      std::back_inserter(result), condition);
         return result;
     }
     
-    int getTotalStock() const {
-        return std::accumulate(products.begin(), products.end(), 0,
-            [](int sum, const T& p) { return sum + p->getStock(); });
+    int getTotalStock() const {
+        std::lock_guard<std::mutex> lock(shardMutex);
+        return std::accumulate(products.begin(), products.end(), 0,
+            [](int sum, const T& p) { return sum + p->getStock(); });
+    }
+    
+    double getTotalValue() const {
+        std::lock_guard<std::mutex> lock(shardMutex);
+        return std::accumulate(products.begin(), products.end(), 0.0,
+            [](double sum, const T& p) { return sum + (p->getPrice() * p->getStock()); });
+    }
+    
+    const std::vector<T>& getAllProducts() const {
+        return products;
+    }
+    
+    size_t indexBytes() const {
+        std::lock_guard<std::mutex> lock(shardMutex);
+        size_t bytes = products.capacity() * sizeof(T) + hashMapBytes(idIndex);
+        for (const auto& entry : idIndex) {
+            bytes += stringHeapBytes(entry.first);
+        }
+        return bytes;
+    }
+    
+    size_t snapshotCacheBytes() const {
+        std::lock_guard<std::mutex> lock(shardMutex);
+        if (!lastSnapshot) {
+            return 0;
+        }
+        size_t bytes = sizeof(InventorySnapshot<T>) + 
+                       lastSnapshot->getRecords().capacity() * sizeof(typename InventorySnapshot<T>::RecordPtr);
+        for (const auto& record : lastSnapshot->getRecords()) {
+            bytes += sizeof(ProductRecord<T>) + stringHeapBytes(record->id) + stringHeapBytes(record->name) +
+                     stringHeapBytes(record->category) + stringHeapBytes(record->details) + 
+                     stringHeapBytes(record->csv);
+        }
+        return bytes;
+    }
+    
+    static void saveSnapshot(const InventorySnapshot<T>& view, const std::string& filename, 
+                             int checkpoint = -1) {
+        AsyncFileWriter file(filename);
+        if (checkpoint >= 0) {
+            file.writeLine("#checkpoint," + std::to_string(checkpoint));
+        }
+        for (const auto& record : view.getRecords()) {
+            file.writeLine(record->csv);
+        }
+        file.commit();
+    }
+    
+    bool hasLoadFailed() const {
+        std::lock_guard<std::mutex> lock(shardMutex);
+        return loadFailed;
+    }
+    
+    int getStockCheckpoint() const {
+        std::lock_guard<std::mutex> lock(shardMutex);
+        return stockCheckpoint;
+    }
+    
+    void loadFromFile(const std::string& filename) {
+        std::vector<T> loaded;
+        int checkpoint = -1;
+        try {
+            readProducts(filename, loaded, checkpoint);
+        } catch (...) {
+            for (const auto& product : loaded) {
+                delete product;
+            }
+            std::lock_guard<std::mutex> lock(shardMutex);
+            loadFailed = true;
+            throw;
+        }
+        
+        std::lock_guard<std::mutex> lock(shardMutex);
+        releaseAllUnlocked();
+        for (const auto& product : loaded) {
+            insertUnlocked(product);
+        }
+        loadFailed = false;
+        stockCheckpoint = checkpoint;
+    }
+    
+    static void readProducts(const std::string& filename, std::vector<T>& loaded, int& checkpoint) {
+        AsyncFileReader file(filename);
+        if (!file.isOpen()) {
+            return;
+        }
+        
+        std::string line;
+        size_t lineNumber = 0;
+        while (file.getline(line)) {
+            lineNumber++;
+            if (line.empty()) continue;
+            try {
+                readProductLine(line, loaded, checkpoint);
+            } catch (const std::exception& e) {
+                throw std::runtime_error("Malformed record at " + filename + ":" + 
+                                         std::to_string(lineNumber) + " (" + e.what() + ")");
+            }
+        }
+    }
+    
+    static void readProductLine(const std::string& line, std::vector<T>& loaded, int& checkpoint) {
+        if (line[0] == '#') {
+            if (line.compare(0, 12, "#checkpoint,") == 0) {
+                checkpoint = std::stoi(line.substr(12));
+            }
+            return;
+        }
+        
+        auto tokens = split(line, ',');
+        if (tokens.empty()) return;
+        
+        std::string type = tokens[0];
+        Product* product = nullptr;
+        
+        if (type == "Clothing") {
+            product = new Clothing();
+        } else if (type == "Stationery") {
+            product = new Stationery();
+        } else if (type == "Accessory") {
+            product = new Accessory();
+        }
+        
+        if (product) {
+            loaded.push_back(product);
+            product->fromCSV(line);
+        }
+    }
+    
+    void compact() {
+        std::vector<T> retired;
+        {
+            std::lock_guard<std::mutex> lock(shardMutex);
+            retired.reserve(products.size());
+            for (auto& p : products) {
+                T moved = p->clone();
+                p->relocateTo(moved);
+                ProductSlotTable::instance().relocate(p->getHandle(), moved);
+                retired.push_back(p);
+                p = moved;
+            }
+            structureVersion++;
+        }
+        EpochReclaimer::instance().retire([retired]() {
+            for (const auto& p : retired) {
+                delete p;
+            }
+        });
+    }
+    
+    static int getGlobalStock(const std::vector<Inventory*>& shards) {
+        int total = 0;
+        for (const auto* shard : shards) {
+            total += shard->getTotalStock();
+        }
+        return total;
+    }
+    
+    static double getGlobalValue(const std::vector<Inventory*>& shards) {
+        double total = 0;
+        for (const auto* shard : shards) {
+            total += shard->getTotalValue();
+        }
+        return total;
+    }
+    
+    static std::vector<std::pair<std::string, int>> locateProduct(
+            const std::vector<Inventory*>& shards, const std::string& id) {
+        std::vector<std::pair<std::string, int>> result;
+        for (const auto* shard : shards) {
+            std::lock_guard<std::mutex> lock(shard->shardMutex);
+            T p = shard->findUnlocked(id);
+            if (p) {
+                result.emplace_back(shard->inventoryName, p->getStock());
+            }
+        }
+        return result;
+    }
+    
+    static void transferStock(Inventory& from, Inventory& to, 
+                              const std::string& id, int quantity) {
+        if (&from == &to) {
+            throw std::invalid_argument("Source and destination stores must differ");
+        }
+        if (quantity <= 0) {
+            throw std::invalid_argument("Quantity must be positive");
+        }
+        
+        std::unique_lock<std::mutex> lockFrom(from.shardMutex, std::defer_lock);
+        std::unique_lock<std::mutex> lockTo(to.shardMutex, std::defer_lock);
+        std::lock(lockFrom, lockTo);
+        
+        T source = from.findUnlocked(id);
+        if (!source) {
+            throw std::invalid_argument("Product " + id + " not found in " + from.inventoryName);
+        }
+        if (source->getStock() < quantity) {
+            throw InsufficientStockException(source->getName(), quantity, source->getStock());
+        }
+        
+        T target = to.findUnlocked(id);
+        bool created = false;
+        if (!target) {
+            target = source->clone();
+            target->attachToShard(&to.shardState);
+            created = true;
+        }
+        
+        try {
+            source->updateStock(-quantity);
+        } catch (...) {
+            if (created) {
+                delete target;
+            }
+            throw;
+        }
+        target->updateStock(created ? quantity - target->getStock() : quantity);
+        if (created) {
+            to.insertUnlocked(target);
+        }
+    }
+};
+
+template<typename T>
+class StoreNetwork {
+private:
+    struct Store {
+        std::unique_ptr<Inventory<T>> inventory;
+        std::string dataFile;
+    };
+    
+    std::vector<Store> stores;
+    std::string configFile;
+    
+    template<typename Task>
+    void forEachStoreInParallel(Task task) const {
+        runInParallel(stores.size(), [this, &task](size_t i) { task(stores[i]); });
+    }
+    
+public:
+    StoreNetwork(const std::string& config) : configFile(config) {}
+    
+    void addStore(const std::string& name, const std::string& dataFile, bool loadExisting = false) {
+        if (indexOf(name) >= 0) {
+            throw std::invalid_argument("Store already exists: " + name);
+        }
+        if (dataFile == configFile) {
+            throw std::invalid_argument(dataFile + " is the store list, not a data file");
+        }
+        for (const auto& existing : stores) {
+            if (existing.dataFile == dataFile) {
+                throw std::invalid_argument(dataFile + " is already used by " + existing.inventory->getName());
+            }
+        }
+        
+        Store store;
+        store.inventory.reset(new Inventory<T>(name));
+        store.dataFile = dataFile;
+        if (loadExisting) {
+            store.inventory->loadFromFile(dataFile);
+        }
+        stores.push_back(std::move(store));
+    }
+    
+    size_t size() const { return stores.size(); }
+    
+    Inventory<T>& getStore(size_t index) { return *stores.at(index).inventory; }
+    const Inventory<T>& getStore(size_t index) const { return *stores.at(index).inventory; }
+    const std::string& getDataFile(size_t index) const { return stores.at(index).dataFile; }
+    
+    int indexOf(const std::string& name) const {
+        for (size_t i = 0; i < stores.size(); i++) {
+            if (stores[i].inventory->getName() == name) {
+                return static_cast<int>(i);
+            }
+        }
+        return -1;
+    }
+    
+    std::vector<Inventory<T>*> shards() const {
+        std::vector<Inventory<T>*> result;
+        for (const auto& store : stores) {
+            result.push_back(store.inventory.get());
+        }
+        return result;
+    }
+    
+    T findProduct(const std::string& id) {
+        for (auto& store : stores) {
+            T p = store.inventory->findProduct(id);
+            if (p) {
+                return p;
+            }
+        }
+        return nullptr;
+    }
+    
+    void loadConfig(const std::string& defaultName, const std::string& defaultFile) {
+        stores.clear();
+        std::ifstream file(configFile);
+        std::string line;
+        
+        while (file.is_open() && std::getline(file, line)) {
+            size_t comma = line.rfind(',');
+            if (line.empty() || comma == std::string::npos) continue;
+            try {
+                addStore(line.substr(0, comma), line.substr(comma + 1));
+            } catch (const std::invalid_argument& e) {
+                std::cerr << "Ignoring entry in " << configFile << ": " << e.what() << "\n";
+            }
+        }
+        
+        if (stores.empty()) {
+            addStore(defaultName, defaultFile);
+        }
+    }
+    
+    std::vector<std::string> loadAll() {
+        std::vector<std::string> errors(stores.size());
+        runInParallel(stores.size(), [this, &errors](size_t i) {
+            try {
+                stores[i].inventory->loadFromFile(stores[i].dataFile);
+            } catch (const std::exception& e) {
+                errors[i] = stores[i].inventory->getName() + ": " + e.what();
+            }
+        });
+        errors.erase(std::remove(errors.begin(), errors.end(), std::string()), errors.end());
+        return errors;
+    }
+    
+    std::vector<std::string> failedStores() const {
+        std::vector<std::string> names;
+        for (const auto& store : stores) {
+            if (store.inventory->hasLoadFailed()) {
+                names.push_back(store.inventory->getName());
+            }
+        }
+        return names;
+    }
+    
+    std::function<void()> prepareSave(int checkpoint) const {
+        std::string config = configFile;
+        std::string configText;
+        std::vector<std::pair<std::string, std::shared_ptr<const InventorySnapshot<T>>>> views;
+        
+        for (const auto& store : stores) {
+            configText += store.inventory->getName() + "," + store.dataFile + "\n";
+            if (!store.inventory->hasLoadFailed()) {
+                views.emplace_back(store.dataFile, store.inventory->snapshot());
+            }
+        }
+        
+        return [config, configText, views, checkpoint]() {
+            AsyncFileWriter file(config);
+            file.write(configText);
+            file.commit();
+            
+            runInParallel(views.size(), [&views, checkpoint](size_t i) {
+                Inventory<T>::saveSnapshot(*views[i].second, views[i].first, checkpoint);
+            });
+        };
+    }
+    
+    int getGlobalStock() const {
+        return Inventory<T>::getGlobalStock(shards());
+    }
+    
+    double getGlobalValue() const {
+        return Inventory<T>::getGlobalValue(shards());
+    }
+    
+    std::vector<std::pair<std::string, int>> locateProduct(const std::string& id) const {
+        return Inventory<T>::locateProduct(shards(), id);
+    }
+    
+    void transferStock(size_t from, size_t to, const std::string& id, int quantity) {
+        Inventory<T>::transferStock(getStore(from), getStore(to), id, quantity);
+    }
+};
+
+class OrderItem {
+private:
+    ProductHandle product;
+    std::string productId;
+    int quantity;
+    double unitPrice;
+    
+public:
+    OrderItem(Product* p, int qty) 
+        : product(p->getHandle()), productId(p->getId()), quantity(qty), unitPrice(p->getPrice()) {}
+    
+    OrderItem(Product* p, int qty, double price) 
+        : product(p->getHandle()), productId(p->getId()), quantity(qty), unitPrice(price) {}
+    
+    OrderItem(const std::string& id, int qty, double price) 
+        : productId(id), quantity(qty), unitPrice(price) {}
+    
+    double getTotal() const {
+        return unitPrice * quantity;
+    }
+    
+    void display() const {
+        Product* p = getProduct();
+        std::cout << (p ? p->getName() : productId + " (discontinued)") << " x " << quantity 
+                  << " @ Rs." << unitPrice 
+                  << " = Rs." << getTotal() << "\n";
+    }
+    
+    Product* getProduct() const { return ProductSlotTable::instance().resolve(product); }
+    ProductHandle getHandle() const { return product; }
+    const std::string& getProductId() const { return productId; }
+    int getQuantity() const { return quantity; }
+    double getUnitPrice() const { return unitPrice; }
+    
+    std::string toCSV() const {
+        std::stringstream ss;
+        ss << productId << "," << quantity << "," << unitPrice;
+        return ss.str();
+    }
+};
+
+struct CustomerOrderEntry {
+    int orderId;
+    time_t orderDate;
+    double amount;
+};
+
+struct CustomerSummary {
+    uint32_t customerId;
+    std::string name;
+    int orderCount;
+    double lifetimeSpend;
+    time_t lastOrderDate;
+    std::vector<CustomerOrderEntry> history;
+};
+
+class CustomerRegistry {
+private:
+    std::vector<CustomerSummary> customers;
+    std::unordered_map<std::string, uint32_t> byName;
+    std::set<std::pair<double, uint32_t>> bySpend;
+    mutable std::mutex mutex;
+    
+    CustomerRegistry() {}
+    
+public:
+    CustomerRegistry(const CustomerRegistry&) = delete;
+    CustomerRegistry& operator=(const CustomerRegistry&) = delete;
+    
+    static CustomerRegistry& instance() {
+        static CustomerRegistry registry;
+        return registry;
+    }
+    
+    uint32_t intern(const std::string& name) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = byName.find(name);
+        if (it != byName.end()) {
+            return it->second;
+        }
+        
+        uint32_t id = static_cast<uint32_t>(customers.size());
+        customers.push_back(CustomerSummary{id, name, 0, 0, 0, {}});
+        byName[name] = id;
+        bySpend.insert({0.0, id});
+        return id;
+    }
+    
+    std::string nameOf(uint32_t id) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return id < customers.size() ? customers[id].name : std::string();
+    }
+    
+    void recordOrder(uint32_t id, int orderId, double amount, time_t date) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (id >= customers.size()) {
+            return;
+        }
+        
+        CustomerSummary& customer = customers[id];
+        bySpend.erase({customer.lifetimeSpend, id});
+        customer.orderCount++;
+        customer.lifetimeSpend += amount;
+        customer.lastOrderDate = std::max(customer.lastOrderDate, date);
+        customer.history.push_back(CustomerOrderEntry{orderId, date, amount});
+        bySpend.insert({customer.lifetimeSpend, id});
+    }
+    
+    void mergeTotals(const CustomerSummary& totals) {
+        uint32_t id = intern(totals.name);
+        std::lock_guard<std::mutex> lock(mutex);
+        CustomerSummary& customer = customers[id];
+        bySpend.erase({customer.lifetimeSpend, id});
+        customer.orderCount += totals.orderCount;
+        customer.lifetimeSpend += totals.lifetimeSpend;
+        customer.lastOrderDate = std::max(customer.lastOrderDate, totals.lastOrderDate);
+        bySpend.insert({customer.lifetimeSpend, id});
+    }
+    
+    void resetAggregates() {
+        std::lock_guard<std::mutex> lock(mutex);
+        bySpend.clear();
+        for (auto& customer : customers) {
+            customer.orderCount = 0;
+            customer.lifetimeSpend = 0;
+            customer.lastOrderDate = 0;
+            customer.history.clear();
+            bySpend.insert({0.0, customer.customerId});
+        }
+    }
+    
+    bool find(const std::string& name, CustomerSummary& result) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = byName.find(name);
+        if (it == byName.end()) {
+            return false;
+        }
+        result = customers[it->second];
+        return true;
+    }
+    
+    std::vector<CustomerSummary> topCustomers(size_t count) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::vector<CustomerSummary> result;
+        for (auto it = bySpend.rbegin(); it != bySpend.rend() && result.size() < count; ++it) {
+            const CustomerSummary& customer = customers[it->second];
+            if (customer.orderCount == 0) {
+                break;
+            }
+            result.push_back(CustomerSummary{customer.customerId, customer.name, customer.orderCount,
+                                             customer.lifetimeSpend, customer.lastOrderDate, {}});
+        }
+        return result;
+    }
+    
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return customers.size();
+    }
+    
+    size_t memoryFootprint() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        size_t bytes = customers.capacity() * sizeof(CustomerSummary) + hashMapBytes(byName) +
+                       bySpend.size() * (sizeof(std::pair<double, uint32_t>) + 4 * sizeof(void*));
+        for (const auto& customer : customers) {
+            bytes += 2 * stringHeapBytes(customer.name) + 
+                     customer.history.capacity() * sizeof(CustomerOrderEntry);
+        }
+        return bytes;
+    }
+};
+
+struct OrderLine {
+    std::string productId;
+    int quantity;
+    double unitPrice;
+};
+
+struct ParsedOrder {
+    std::string store;
+    int orderId;
+    std::string customerName;
+    double totalAmount;
+    time_t orderDate;
+    std::vector<OrderLine> lines;
+    
+    static bool parse(const std::string& csvLine, ParsedOrder& out) {
+        auto tokens = split(csvLine, ',');
+        if (tokens.size() < 5) {
+            return false;
+        }
+        
+        try {
+            ParsedOrder parsed;
+            parsed.orderId = std::stoi(tokens[0]);
+            parsed.customerName = tokens[1];
+            parsed.totalAmount = std::stod(tokens[2]);
+            parsed.orderDate = std::stol(tokens[3]);
+            int itemCount = std::stoi(tokens[4]);
+            if (itemCount < 0 || tokens.size() != 5 + 3 * static_cast<size_t>(itemCount)) {
+                return false;
+            }
+            
+            for (size_t index = 5; index < tokens.size(); index += 3) {
+                int quantity = std::stoi(tokens[index + 1]);
+                if (quantity <= 0) {
+                    return false;
+                }
+                parsed.lines.push_back(OrderLine{tokens[index], quantity, std::stod(tokens[index + 2])});
+            }
+            out = parsed;
+            return true;
+        } catch (const std::exception&) {
+            return false;
+        }
+    }
+};
+
+class Order {
+private:
+    static int orderCounter;
+    int orderId;
+    uint32_t customerId;
+    std::vector<OrderItem> items;
+    double totalAmount;
+    time_t orderDate;
+    
+public:
+    Order(const std::string& customer = "") 
+        : customerId(CustomerRegistry::instance().intern(checkCustomerName(customer))), totalAmount(0) {
+        orderId = ++orderCounter;
+        orderDate = time(nullptr);
+    }
+    
+    Order(int id, const std::string& customer, time_t date)
+        : orderId(id), customerId(CustomerRegistry::instance().intern(customer)),
+          totalAmount(0), orderDate(date) {}
+    
+    void addItem(Product* product, int quantity) {
+        if (quantity <= 0) {
+            throw std::invalid_argument("Quantity must be positive");
+        }
+        
+        product->updateStock(-quantity);
+        items.emplace_back(product, quantity);
+        totalAmount += items.back().getTotal();
+    }
+    
+    void restoreItem(Product* product, int quantity, double unitPrice) {
+        items.emplace_back(product, quantity, unitPrice);
+        totalAmount += items.back().getTotal();
+    }
+    
+    void display() const {
+        std::cout << "\n=== Order Details ===\n";
+        std::cout << "Order ID: " << orderId << "\n";
+        std::cout << "Customer: " << getCustomerName() << "\n";
+        std::cout << "Date: " << ctime(&orderDate);
+        std::cout << "\nItems:\n";
+        
+        for (const auto& item : items) {
+            std::cout << "  ";
+            item.display();
+        }
+        
+        std::cout << "\nTotal Amount: Rs." << totalAmount << "\n";
+        std::cout << "====================\n";
+    }
+    
+    double getTotalAmount() const { return totalAmount; }
+    int getOrderId() const { return orderId; }
+    time_t getOrderDate() const { return orderDate; }
+    std::string getCustomerName() const { return CustomerRegistry::instance().nameOf(customerId); }
+    uint32_t getCustomerId() const { return customerId; }
+    const std::vector<OrderItem>& getItems() const { return items; }
+    
+    size_t memoryFootprint() const {
+        size_t bytes = sizeof(Order) + items.capacity() * sizeof(OrderItem);
+        for (const auto& item : items) {
+            bytes += stringHeapBytes(item.getProductId());
+        }
+        return bytes;
+    }
+    
+    std::string toCSV() const {
+        std::stringstream ss;
+        ss << orderId << "," << getCustomerName() << "," << totalAmount << "," 
+           << orderDate << "," << items.size();
+        
+        for (const auto& item : items) {
+            ss << "," << item.toCSV();
+        }
+        
+        return ss.str();
+    }
+    
+    template<typename Catalog>
+    bool fromCSV(const std::string& csvLine, Catalog& inventory) {
+        ParsedOrder parsed;
+        if (!ParsedOrder::parse(csvLine, parsed)) {
+            return false;
+        }
+        
+        orderId = parsed.orderId;
+        customerId = CustomerRegistry::instance().intern(parsed.customerName);
+        totalAmount = parsed.totalAmount;
+        orderDate = parsed.orderDate;
+        items.clear();
+        
+        for (const auto& line : parsed.lines) {
+            Product* product = inventory.findProduct(line.productId);
+            if (product) {
+                items.emplace_back(product, line.quantity, line.unitPrice);
+            } else {
+                items.emplace_back(line.productId, line.quantity, line.unitPrice);
+            }
+        }
+        
+        observeOrderId(orderId);
+        return true;
+    }
+    
+    static void observeOrderId(int id) {
+        if (id > orderCounter) {
+            orderCounter = id;
+        }
+    }
+    
+    static int lastOrderId() {
+        return orderCounter;
+    }
+    
+    static bool isValidCustomerName(const std::string& name) {
+        return name.find_first_of(",\t\r\n") == std::string::npos;
+    }
+    
+    static const std::string& checkCustomerName(const std::string& name) {
+        if (!isValidCustomerName(name)) {
+            throw std::invalid_argument("Customer name cannot contain commas, tabs or line breaks");
+        }
+        return name;
+    }
+};
+
+int Order::orderCounter = 1000;
+
+class OrderIdRanges {
+private:
+    std::map<int, int> ranges;
+    size_t total;
+    
+public:
+    OrderIdRanges() : total(0) {}
+    
+    bool insert(int id) {
+        auto next = ranges.upper_bound(id);
+        if (next != ranges.begin()) {
+            auto previous = std::prev(next);
+            if (id <= previous->second) {
+                return false;
+            }
+            if (id == previous->second + 1) {
+                previous->second = id;
+                if (next != ranges.end() && next->first == id + 1) {
+                    previous->second = next->second;
+                    ranges.erase(next);
+                }
+                total++;
+                return true;
+            }
+        }
+        
+        int last = id;
+        if (next != ranges.end() && next->first == id + 1) {
+            last = next->second;
+            ranges.erase(next);
+        }
+        ranges[id] = last;
+        total++;
+        return true;
+    }
+    
+    bool appendRange(int first, int last) {
+        if (last < first || (!ranges.empty() && first <= ranges.rbegin()->second + 1)) {
+            return false;
+        }
+        ranges[first] = last;
+        total += static_cast<size_t>(last - first) + 1;
+        return true;
+    }
+    
+    size_t count(int id) const {
+        auto next = ranges.upper_bound(id);
+        return next != ranges.begin() && id <= std::prev(next)->second ? 1 : 0;
+    }
+    
+    size_t size() const { return total; }
+    bool empty() const { return total == 0; }
+    int last() const { return ranges.empty() ? 0 : ranges.rbegin()->second; }
+    
+    std::map<int, int>::const_iterator begin() const { return ranges.begin(); }
+    std::map<int, int>::const_iterator end() const { return ranges.end(); }
+};
+
+struct JournalSegment {
+    uint32_t index;
+    std::string path;
+    std::vector<ParsedOrder> orders;
+    size_t validBytes;
+    size_t fileBytes;
+    std::vector<ParsedOrder> afterDamage;
+    
+    bool isTorn() const { return validBytes < fileBytes && afterDamage.empty(); }
+    bool isDamaged() const { return !afterDamage.empty(); }
+};
+
+class OrderJournal {
+private:
+    std::string prefix;
+    size_t recordsPerSegment;
+    int fd;
+    uint32_t activeSegment;
+    size_t recordsInSegment;
+    std::mutex mutex;
+    
+    struct Crc32Table {
+        uint32_t entries[256];
+        
+        Crc32Table() {
+            for (uint32_t i = 0; i < 256; i++) {
+                uint32_t c = i;
+                for (int k = 0; k < 8; k++) {
+                    c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                }
+                entries[i] = c;
+            }
+        }
+    };
+    
+    static uint32_t crc32(const std::string& data) {
+        static const Crc32Table table;
+        uint32_t crc = 0xFFFFFFFFu;
+        for (unsigned char c : data) {
+            crc = table.entries[(crc ^ c) & 0xFF] ^ (crc >> 8);
+        }
+        return crc ^ 0xFFFFFFFFu;
+    }
+    
+    std::string segmentPath(uint32_t index) const {
+        char suffix[16];
+        snprintf(suffix, sizeof(suffix), "%06u", index);
+        return prefix + suffix;
+    }
+    
+    std::vector<uint32_t> listSegments() const {
+        size_t slash = prefix.rfind('/');
+        std::string directory = slash == std::string::npos ? "." : prefix.substr(0, slash);
+        std::string base = slash == std::string::npos ? prefix : prefix.substr(slash + 1);
+        
+        std::vector<uint32_t> segments;
+        DIR* dir = opendir(directory.c_str());
+        if (!dir) {
+            return segments;
+        }
+        while (struct dirent* entry = readdir(dir)) {
+            std::string name = entry->d_name;
+            if (name.size() == base.size() + 6 && name.compare(0, base.size(), base) == 0 &&
+                name.find_first_not_of("0123456789", base.size()) == std::string::npos) {
+                segments.push_back(static_cast<uint32_t>(std::stoul(name.substr(base.size()))));
+            }
+        }
+        closedir(dir);
+        std::sort(segments.begin(), segments.end());
+        return segments;
+    }
+    
+    void closeSegment() {
+        if (fd >= 0) {
+            fdatasync(fd);
+            close(fd);
+            fd = -1;
+        }
+    }
+    
+    static bool readRecord(const std::string& data, size_t pos, ParsedOrder& order) {
+        size_t newline = data.find('\n', pos);
+        if (newline == std::string::npos || newline - pos < 10 || data[pos + 8] != '|') {
+            return false;
+        }
+        
+        std::string payload = data.substr(pos + 9, newline - pos - 9);
+        char* end = nullptr;
+        std::string checksum = data.substr(pos, 8);
+        unsigned long expected = strtoul(checksum.c_str(), &end, 16);
+        size_t tab = payload.find('\t');
+        std::string csv = tab == std::string::npos ? payload : payload.substr(tab + 1);
+        if (*end != '\0' || expected != crc32(payload) || !ParsedOrder::parse(csv, order)) {
+            return false;
+        }
+        order.store = tab == std::string::npos ? std::string() : payload.substr(0, tab);
+        return true;
+    }
+    
+    static JournalSegment scanSegment(uint32_t index, const std::string& path) {
+        JournalSegment segment{index, path, {}, 0, 0, {}};
+        std::ifstream file(path, std::ios::binary);
+        std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        segment.fileBytes = data.size();
+        
+        size_t pos = 0;
+        ParsedOrder order;
+        while (pos < data.size() && readRecord(data, pos, order)) {
+            segment.orders.push_back(order);
+            pos = data.find('\n', pos) + 1;
+        }
+        segment.validBytes = pos;
+        
+        for (size_t next = data.find('\n', pos); next != std::string::npos && next + 1 < data.size();
+             next = data.find('\n', next + 1)) {
+            if (readRecord(data, next + 1, order)) {
+                segment.afterDamage.push_back(order);
+            }
+        }
+        return segment;
+    }
+    
+public:
+    OrderJournal(const std::string& filePrefix, size_t segmentRecords = 10000)
+        : prefix(filePrefix), recordsPerSegment(segmentRecords), fd(-1), recordsInSegment(0) {
+        std::vector<uint32_t> existing = listSegments();
+        activeSegment = existing.empty() ? 0 : existing.back() + 1;
+    }
+    
+    ~OrderJournal() {
+        closeSegment();
+    }
+    
+    OrderJournal(const OrderJournal&) = delete;
+    OrderJournal& operator=(const OrderJournal&) = delete;
+    
+    void append(const Order& order, const std::string& store) {
+        std::string payload = store + "\t" + order.toCSV();
+        char checksum[16];
+        snprintf(checksum, sizeof(checksum), "%08x|", crc32(payload));
+        std::string record = checksum + payload + "\n";
+        
+        std::lock_guard<std::mutex> lock(mutex);
+        if (fd >= 0 && recordsInSegment >= recordsPerSegment) {
+            closeSegment();
+            activeSegment++;
+        }
+        if (fd < 0) {
+            fd = open(segmentPath(activeSegment).c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+            recordsInSegment = 0;
+            if (fd < 0) {
+                throw FileIOException(segmentPath(activeSegment), "journal");
+            }
+        }
+        
+        const char* data = record.data();
+        size_t remaining = record.size();
+        while (remaining > 0) {
+            ssize_t n = ::write(fd, data, remaining);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                throw FileIOException(segmentPath(activeSegment), "journal");
+            }
+            data += n;
+            remaining -= static_cast<size_t>(n);
+        }
+        recordsInSegment++;
+    }
+    
+    void sync() {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (fd >= 0) {
+            fdatasync(fd);
+        }
+    }
+    
+    uint32_t rotate() {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (fd >= 0) {
+            closeSegment();
+            activeSegment++;
+        }
+        return activeSegment;
+    }
+    
+    size_t discardCovered(uint32_t checkpoint, const OrderIdRanges& saved) {
+        size_t kept = 0;
+        for (uint32_t index : listSegments()) {
+            if (index >= checkpoint) {
+                continue;
+            }
+            JournalSegment segment = scanSegment(index, segmentPath(index));
+            bool covered = !segment.isDamaged() && std::all_of(segment.orders.begin(), segment.orders.end(),
+                [&saved](const ParsedOrder& order) { return saved.count(order.orderId) > 0; });
+            if (covered) {
+                unlink(segment.path.c_str());
+            } else {
+                kept++;
+            }
+        }
+        return kept;
+    }
+    
+    std::vector<JournalSegment> scan(bool truncateTornTails) {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::vector<uint32_t> indexes = listSegments();
+        std::vector<JournalSegment> segments(indexes.size());
+        
+        runInParallel(indexes.size(), [this, &indexes, &segments](size_t i) {
+            segments[i] = scanSegment(indexes[i], segmentPath(indexes[i]));
+        });
+        
+        if (truncateTornTails) {
+            for (const auto& segment : segments) {
+                if (segment.isTorn() && truncate(segment.path.c_str(), segment.validBytes) != 0) {
+                    throw FileIOException(segment.path, "truncate");
+                }
+            }
+        }
+        return segments;
+    }
+};
+
+class ByteWriter {
+private:
+    std::string buffer;
+    
+public:
+    void putByte(uint8_t value) {
+        buffer.push_back(static_cast<char>(value));
+    }
+    
+    void putFixed(uint64_t value, int bytes) {
+        for (int i = 0; i < bytes; i++) {
+            putByte(static_cast<uint8_t>(value >> (8 * i)));
+        }
+    }
+    
+    void putVarint(uint64_t value) {
+        while (value >= 0x80) {
+            putByte(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        putByte(static_cast<uint8_t>(value));
+    }
+    
+    void putSigned(int64_t value) {
+        putVarint((static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+    }
+    
+    void putCents(double amount) {
+        putSigned(static_cast<int64_t>(amount * 100 + (amount < 0 ? -0.5 : 0.5)));
+    }
+    
+    void putString(const std::string& value) {
+        putVarint(value.size());
+        buffer += value;
+    }
+    
+    void putBitPacked(const std::vector<uint32_t>& values) {
+        uint32_t maxValue = 0;
+        for (uint32_t v : values) {
+            maxValue = std::max(maxValue, v);
+        }
+        unsigned width = 1;
+        while (width < 32 && (maxValue >> width) != 0) {
+            width++;
+        }
+        putByte(static_cast<uint8_t>(width));
+        
+        uint64_t acc = 0;
+        unsigned bits = 0;
+        for (uint32_t v : values) {
+            acc |= static_cast<uint64_t>(v) << bits;
+            bits += width;
+            while (bits >= 8) {
+                putByte(static_cast<uint8_t>(acc));
+                acc >>= 8;
+                bits -= 8;
+            }
+        }
+        if (bits > 0) {
+            putByte(static_cast<uint8_t>(acc));
+        }
+    }
+    
+    std::string& data() { return buffer; }
+};
+
+class ByteReader {
+private:
+    const std::string& buffer;
+    size_t pos;
+    std::string context;
+    
+public:
+    explicit ByteReader(const std::string& data, const std::string& what = "archive block") 
+        : buffer(data), pos(0), context(what) {}
+    
+    bool atEnd() const { return pos >= buffer.size(); }
+    size_t remaining() const { return pos < buffer.size() ? buffer.size() - pos : 0; }
+    
+    uint8_t getByte() {
+        if (pos >= buffer.size()) {
+            throw CorruptDataException(context, "unexpected end of data");
+        }
+        return static_cast<uint8_t>(buffer[pos++]);
+    }
+    
+    uint64_t getFixed(int bytes) {
+        uint64_t value = 0;
+        for (int i = 0; i < bytes; i++) {
+            value |= static_cast<uint64_t>(getByte()) << (8 * i);
+        }
+        return value;
+    }
+    
+    uint64_t getVarint() {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            uint8_t byte = getByte();
+            value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) {
+                return value;
+            }
+        }
+        throw CorruptDataException(context, "varint overflow");
+    }
+    
+    int64_t getSigned() {
+        uint64_t raw = getVarint();
+        return static_cast<int64_t>(raw >> 1) ^ -static_cast<int64_t>(raw & 1);
+    }
+    
+    double getCents() {
+        return getSigned() / 100.0;
+    }
+    
+    std::string getString() {
+        size_t length = getVarint();
+        if (length > buffer.size() - pos) {
+            throw CorruptDataException(context, "string out of range");
+        }
+        std::string value = buffer.substr(pos, length);
+        pos += length;
+        return value;
+    }
+    
+    std::vector<uint32_t> getBitPacked(size_t count) {
+        unsigned width = getByte();
+        if (width == 0 || width > 32) {
+            throw CorruptDataException(context, "bad bit width");
+        }
+        std::vector<uint32_t> values(count);
+        uint64_t acc = 0;
+        unsigned bits = 0;
+        uint64_t mask = (static_cast<uint64_t>(1) << width) - 1;
+        for (size_t i = 0; i < count; i++) {
+            while (bits < width) {
+                acc |= static_cast<uint64_t>(getByte()) << bits;
+                bits += 8;
+            }
+            values[i] = static_cast<uint32_t>(acc & mask);
+            acc >>= width;
+            bits -= width;
+        }
+        return values;
+    }
+};
+
+struct SalesCell {
+    double revenue;
+    int units;
+    int orders;
+    
+    SalesCell() : revenue(0), units(0), orders(0) {}
+    
+    SalesCell& operator+=(const SalesCell& other) {
+        revenue += other.revenue;
+        units += other.units;
+        orders += other.orders;
+        return *this;
+    }
+};
+
+struct SaleLine {
+    std::string productId;
+    std::string category;
+    int quantity;
+    double unitPrice;
+};
+
+class SalesCube {
+private:
+    struct DaySlice {
+        std::unordered_map<uint32_t, SalesCell> products;
+        std::vector<SalesCell> categories;
+        SalesCell total;
+    };
+    
+    std::vector<std::string> productIds;
+    std::vector<uint16_t> productCategory;
+    std::unordered_map<std::string, uint32_t> productIndex;
+    std::vector<std::string> categories;
+    std::unordered_map<std::string, uint16_t> categoryIndex;
+    std::map<long, DaySlice> days;
+    
+    static long dayOf(time_t t) {
+        return static_cast<long>(t / 86400);
+    }
+    
+    uint16_t internCategory(const std::string& category) {
+        auto it = categoryIndex.find(category);
+        if (it != categoryIndex.end()) {
+            return it->second;
+        }
+        uint16_t id = static_cast<uint16_t>(categories.size());
+        categories.push_back(category);
+        categoryIndex[category] = id;
+        return id;
+    }
+    
+    uint32_t internProduct(const std::string& productId, const std::string& category) {
+        auto it = productIndex.find(productId);
+        if (it != productIndex.end()) {
+            return it->second;
+        }
+        uint32_t id = static_cast<uint32_t>(productIds.size());
+        productIds.push_back(productId);
+        productCategory.push_back(internCategory(category));
+        productIndex[productId] = id;
+        return id;
+    }
+    
+    std::pair<std::map<long, DaySlice>::const_iterator, std::map<long, DaySlice>::const_iterator>
+    range(time_t from, time_t to) const {
+        return std::make_pair(days.lower_bound(dayOf(from)), days.upper_bound(dayOf(to)));
+    }
+    
+    static void putCell(ByteWriter& w, const SalesCell& cell) {
+        w.putCents(cell.revenue);
+        w.putSigned(cell.units);
+        w.putSigned(cell.orders);
+    }
+    
+    static SalesCell getCell(ByteReader& r) {
+        SalesCell cell;
+        cell.revenue = r.getCents();
+        cell.units = static_cast<int>(r.getSigned());
+        cell.orders = static_cast<int>(r.getSigned());
+        return cell;
+    }
+    
+public:
+    void clear() {
+        days.clear();
+    }
+    
+    void recordOrder(time_t date, const std::vector<SaleLine>& lines) {
+        if (lines.empty()) {
+            return;
+        }
+        
+        DaySlice& slice = days[dayOf(date)];
+        std::vector<uint32_t> seenProducts;
+        std::vector<uint16_t> seenCategories;
+        
+        for (const auto& line : lines) {
+            uint32_t product = internProduct(line.productId, line.category);
+            uint16_t category = productCategory[product];
+            if (slice.categories.size() <= category) {
+                slice.categories.resize(category + 1);
+            }
+            
+            SalesCell cell;
+            cell.revenue = line.unitPrice * line.quantity;
+            cell.units = line.quantity;
+            slice.total += cell;
+            
+            bool newCategory = std::find(seenCategories.begin(), seenCategories.end(), category) 
+                               == seenCategories.end();
+            if (newCategory) {
+                seenCategories.push_back(category);
+            }
+            cell.orders = newCategory ? 1 : 0;
+            slice.categories[category] += cell;
+            
+            bool newProduct = std::find(seenProducts.begin(), seenProducts.end(), product) 
+                              == seenProducts.end();
+            if (newProduct) {
+                seenProducts.push_back(product);
+            }
+            cell.orders = newProduct ? 1 : 0;
+            slice.products[product] += cell;
+        }
+        slice.total.orders++;
+    }
+    
+    void recordOrder(const Order& order) {
+        std::vector<SaleLine> lines;
+        for (const auto& item : order.getItems()) {
+            Product* product = item.getProduct();
+            lines.push_back(SaleLine{item.getProductId(), product ? product->getCategory() : "Unknown",
+                                     item.getQuantity(), item.getUnitPrice()});
+        }
+        recordOrder(order.getOrderDate(), lines);
+    }
+    
+    void merge(const SalesCube& other) {
+        std::vector<uint16_t> categoryMap;
+        for (const auto& category : other.categories) {
+            categoryMap.push_back(internCategory(category));
+        }
+        std::vector<uint32_t> productMap;
+        for (size_t p = 0; p < other.productIds.size(); p++) {
+            productMap.push_back(internProduct(other.productIds[p], other.categories[other.productCategory[p]]));
+        }
+        
+        for (const auto& day : other.days) {
+            DaySlice& slice = days[day.first];
+            slice.total += day.second.total;
+            for (size_t c = 0; c < day.second.categories.size(); c++) {
+                uint16_t category = categoryMap[c];
+                if (slice.categories.size() <= category) {
+                    slice.categories.resize(category + 1);
+                }
+                slice.categories[category] += day.second.categories[c];
+            }
+            for (const auto& cell : day.second.products) {
+                slice.products[productMap[cell.first]] += cell.second;
+            }
+        }
+    }
+    
+    void encode(ByteWriter& w) const {
+        w.putVarint(categories.size());
+        for (const auto& category : categories) {
+            w.putString(category);
+        }
+        w.putVarint(productIds.size());
+        for (size_t p = 0; p < productIds.size(); p++) {
+            w.putString(productIds[p]);
+            w.putVarint(productCategory[p]);
+        }
+        
+        w.putVarint(days.size());
+        long previousDay = 0;
+        for (const auto& day : days) {
+            w.putSigned(day.first - previousDay);
+            previousDay = day.first;
+            putCell(w, day.second.total);
+            w.putVarint(day.second.categories.size());
+            for (const auto& cell : day.second.categories) {
+                putCell(w, cell);
+            }
+            w.putVarint(day.second.products.size());
+            for (const auto& cell : day.second.products) {
+                w.putVarint(cell.first);
+                putCell(w, cell.second);
+            }
+        }
+    }
+    
+    static SalesCube decode(ByteReader& r) {
+        SalesCube cube;
+        for (size_t i = 0, n = r.getVarint(); i < n; i++) {
+            if (cube.internCategory(r.getString()) != i) {
+                throw CorruptDataException("sales summary", "duplicate category");
+            }
+        }
+        for (size_t i = 0, n = r.getVarint(); i < n; i++) {
+            std::string productId = r.getString();
+            size_t category = r.getVarint();
+            if (category >= cube.categories.size() || 
+                cube.internProduct(productId, cube.categories[category]) != i) {
+                throw CorruptDataException("sales summary", "bad product entry");
+            }
+        }
+        
+        long day = 0;
+        for (size_t i = 0, n = r.getVarint(); i < n; i++) {
+            day += static_cast<long>(r.getSigned());
+            DaySlice& slice = cube.days[day];
+            slice.total = getCell(r);
+            for (size_t c = 0, count = r.getVarint(); c < count; c++) {
+                if (c >= cube.categories.size()) {
+                    throw CorruptDataException("sales summary", "category out of range");
+                }
+                slice.categories.push_back(getCell(r));
+            }
+            for (size_t p = 0, count = r.getVarint(); p < count; p++) {
+                uint64_t product = r.getVarint();
+                if (product >= cube.productIds.size()) {
+                    throw CorruptDataException("sales summary", "product out of range");
+                }
+                slice.products[static_cast<uint32_t>(product)] = getCell(r);
+            }
+        }
+        return cube;
+    }
+    
+    bool empty() const { return days.empty(); }
+    
+    size_t memoryFootprint() const {
+        size_t bytes = productIds.capacity() * sizeof(std::string) + productCategory.capacity() * sizeof(uint16_t) +
+                       hashMapBytes(productIndex) + categories.capacity() * sizeof(std::string) + 
+                       hashMapBytes(categoryIndex);
+        for (const auto& id : productIds) {
+            bytes += 2 * stringHeapBytes(id);
+        }
+        for (const auto& day : days) {
+            bytes += sizeof(std::pair<const long, DaySlice>) + 4 * sizeof(void*) +
+                     hashMapBytes(day.second.products) + day.second.categories.capacity() * sizeof(SalesCell);
+        }
+        return bytes;
+    }
+    
+    time_t firstSale() const { return days.empty() ? 0 : days.begin()->first * 86400; }
+    time_t lastSale() const { return days.empty() ? 0 : days.rbegin()->first * 86400; }
+    
+    SalesCell totals(time_t from, time_t to) const {
+        SalesCell result;
+        auto bounds = range(from, to);
+        for (auto it = bounds.first; it != bounds.second; ++it) {
+            result += it->second.total;
+        }
+        return result;
+    }
+    
+    std::map<std::string, SalesCell> revenueByCategory(time_t from, time_t to) const {
+        std::vector<SalesCell> sums(categories.size());
+        auto bounds = range(from, to);
+        for (auto it = bounds.first; it != bounds.second; ++it) {
+            for (size_t c = 0; c < it->second.categories.size(); c++) {
+                sums[c] += it->second.categories[c];
+            }
+        }
+        
+        std::map<std::string, SalesCell> result;
+        for (size_t c = 0; c < sums.size(); c++) {
+            if (sums[c].orders > 0) {
+                result[categories[c]] = sums[c];
+            }
+        }
+        return result;
+    }
+    
+    std::vector<std::pair<std::string, SalesCell>> bestSellers(time_t from, time_t to, size_t topN) const {
+        std::unordered_map<uint32_t, SalesCell> sums;
+        auto bounds = range(from, to);
+        for (auto it = bounds.first; it != bounds.second; ++it) {
+            for (const auto& pair : it->second.products) {
+                sums[pair.first] += pair.second;
+            }
+        }
+        
+        std::vector<std::pair<std::string, SalesCell>> result;
+        for (const auto& pair : sums) {
+            result.emplace_back(productIds[pair.first], pair.second);
+        }
+        
+        size_t count = std::min(topN, result.size());
+        std::partial_sort(result.begin(), result.begin() + count, result.end(),
+            [](const std::pair<std::string, SalesCell>& a, const std::pair<std::string, SalesCell>& b) {
+                return a.second.units > b.second.units;
+            });
+        result.resize(count);
+        return result;
+    }
+    
+    double salesVelocity(const std::string& productId, time_t from, time_t to) const {
+        auto product = productIndex.find(productId);
+        long spanDays = dayOf(to) - dayOf(from) + 1;
+        if (product == productIndex.end() || spanDays <= 0) {
+            return 0;
+        }
+        
+        int units = 0;
+        auto bounds = range(from, to);
+        for (auto it = bounds.first; it != bounds.second; ++it) {
+            auto cell = it->second.products.find(product->second);
+            if (cell != it->second.products.end()) {
+                units += cell->second.units;
+            }
+        }
+        return static_cast<double>(units) / spanDays;
+    }
+};
+
+struct ArchivedItem {
+    std::string productId;
+    int quantity;
+    double unitPrice;
+};
+
+struct ArchivedOrder {
+    int orderId;
+    std::string customerName;
+    double totalAmount;
+    time_t orderDate;
+    std::vector<ArchivedItem> items;
+    
+    static ArchivedOrder fromOrder(const Order& order) {
+        ArchivedOrder archived{order.getOrderId(), order.getCustomerName(),
+                               order.getTotalAmount(), order.getOrderDate(), {}};
+        for (const auto& item : order.getItems()) {
+            archived.items.push_back(ArchivedItem{item.getProductId(),
+                                                  item.getQuantity(), item.getUnitPrice()});
+        }
+        return archived;
+    }
+};
+
+class BlockCompressor {
+private:
+    static const int hashBits = 14;
+    static const size_t maxOffset = 65535;
+    static const size_t minMatch = 4;
+    
+    static uint32_t hashAt(const std::string& in, size_t i) {
+        uint32_t sequence;
+        std::memcpy(&sequence, in.data() + i, sizeof(sequence));
+        return (sequence * 2654435761u) >> (32 - hashBits);
+    }
+    
+public:
+    static std::string compress(const std::string& in) {
+        ByteWriter out;
+        std::vector<long> table(static_cast<size_t>(1) << hashBits, -1);
+        size_t anchor = 0;
+        size_t i = 0;
+        
+        while (i + minMatch <= in.size()) {
+            uint32_t h = hashAt(in, i);
+            long candidate = table[h];
+            table[h] = static_cast<long>(i);
+            
+            if (candidate >= 0 && i - candidate <= maxOffset &&
+                std::memcmp(in.data() + candidate, in.data() + i, minMatch) == 0) {
+                size_t length = minMatch;
+                while (i + length < in.size() && in[candidate + length] == in[i + length]) {
+                    length++;
+                }
+                out.putVarint(i - anchor);
+                out.data().append(in, anchor, i - anchor);
+                out.putVarint(length);
+                out.putVarint(i - candidate);
+                i += length;
+                anchor = i;
+            } else {
+                i++;
+            }
+        }
+        
+        out.putVarint(in.size() - anchor);
+        out.data().append(in, anchor, std::string::npos);
+        return out.data();
+    }
+    
+    static std::string decompress(const std::string& in, size_t rawSize) {
+        std::string out;
+        out.reserve(rawSize);
+        ByteReader reader(in);
+        
+        while (!reader.atEnd()) {
+            size_t literals = reader.getVarint();
+            for (size_t i = 0; i < literals; i++) {
+                out.push_back(static_cast<char>(reader.getByte()));
+            }
+            if (reader.atEnd()) {
+                break;
+            }
+            size_t length = reader.getVarint();
+            size_t offset = reader.getVarint();
+            if (offset == 0 || offset > out.size()) {
+                throw std::runtime_error("Corrupt archive block: bad match offset");
+            }
+            size_t from = out.size() - offset;
+            for (size_t i = 0; i < length; i++) {
+                out.push_back(out[from + i]);
+            }
+        }
+        
+        if (out.size() != rawSize) {
+            throw std::runtime_error("Corrupt archive block: size mismatch");
+        }
+        return out;
+    }
+};
+
+struct ArchiveScanStats {
+    size_t blocksTotal;
+    size_t blocksScanned;
+    size_t ordersTotal;
+    size_t rawBytes;
+    size_t storedBytes;
+    size_t tornBytes;
+    size_t validBytes;
+    size_t lastBlockOffset;
+    uint32_t lastBlockChecksum;
+    
+    ArchiveScanStats() 
+        : blocksTotal(0), blocksScanned(0), ordersTotal(0), rawBytes(0), storedBytes(0), tornBytes(0),
+          validBytes(0), lastBlockOffset(0), lastBlockChecksum(0) {}
+};
+
+class OrderArchive {
+private:
+    static const uint32_t blockMagic = 0x4b4c424f;
+    static const int headerSize = 36;
+    
+    std::string filename;
+    size_t ordersPerBlock;
+    
+    static std::string encodeBlock(std::vector<ArchivedOrder>::const_iterator first,
+                                   std::vector<ArchivedOrder>::const_iterator last) {
+        std::vector<std::string> customers, products;
+        std::unordered_map<std::string, uint32_t> customerIndex, productIndex;
+        auto intern = [](const std::string& key, std::vector<std::string>& dict,
+                         std::unordered_map<std::string, uint32_t>& index) {
+            auto it = index.find(key);
+            if (it != index.end()) {
+                return it->second;
+            }
+            uint32_t id = static_cast<uint32_t>(dict.size());
+            dict.push_back(key);
+            index[key] = id;
+            return id;
+        };
+        
+        std::vector<uint32_t> customerIds, productIds, quantities, itemCounts;
+        for (auto it = first; it != last; ++it) {
+            customerIds.push_back(intern(it->customerName, customers, customerIndex));
+            itemCounts.push_back(static_cast<uint32_t>(it->items.size()));
+            for (const auto& item : it->items) {
+                productIds.push_back(intern(item.productId, products, productIndex));
+                quantities.push_back(static_cast<uint32_t>(item.quantity));
+            }
+        }
+        
+        ByteWriter w;
+        w.putVarint(customers.size());
+        for (const auto& c : customers) w.putString(c);
+        w.putVarint(products.size());
+        for (const auto& p : products) w.putString(p);
+        w.putVarint(productIds.size());
+        
+        int64_t previousId = 0, previousDate = 0;
+        for (auto it = first; it != last; ++it) {
+            w.putSigned(it->orderId - previousId);
+            previousId = it->orderId;
+        }
+        for (auto it = first; it != last; ++it) {
+            w.putSigned(static_cast<int64_t>(it->orderDate) - previousDate);
+            previousDate = it->orderDate;
+        }
+        for (auto it = first; it != last; ++it) {
+            w.putCents(it->totalAmount);
+        }
+        w.putBitPacked(customerIds);
+        w.putBitPacked(itemCounts);
+        w.putBitPacked(productIds);
+        w.putBitPacked(quantities);
+        for (auto it = first; it != last; ++it) {
+            for (const auto& item : it->items) {
+                w.putCents(item.unitPrice);
+            }
+        }
+        return w.data();
+    }
+    
+    static size_t fileSize(std::ifstream& file) {
+        std::streampos current = file.tellg();
+        file.seekg(0, std::ios::end);
+        size_t size = static_cast<size_t>(file.tellg());
+        file.seekg(current);
+        return size;
+    }
+    
+    size_t validLength() const {
+        std::ifstream file(filename, std::ios::binary);
+        if (!file.is_open()) {
+            return 0;
+        }
+        
+        size_t size = fileSize(file);
+        size_t pos = 0;
+        std::string headerBytes(headerSize, '\0');
+        while (pos + headerSize <= size && file.read(&headerBytes[0], headerSize)) {
+            ByteReader header(headerBytes);
+            if (header.getFixed(4) != blockMagic) {
+                break;
+            }
+            header.getFixed(4);
+            header.getFixed(8);
+            header.getFixed(8);
+            header.getFixed(4);
+            size_t storedSize = header.getFixed(4);
+            uint32_t expected = static_cast<uint32_t>(header.getFixed(4));
+            size_t end = pos + headerSize + storedSize;
+            if (end > size) {
+                break;
+            }
+            if (end == size) {
+                std::string stored(storedSize, '\0');
+                if (!file.read(&stored[0], storedSize) || checksum(stored) != expected) {
+                    break;
+                }
+            } else {
+                file.seekg(storedSize, std::ios::cur);
+            }
+            pos = end;
+        }
+        return pos;
+    }
+    
+    static std::vector<ArchivedOrder> decodeBlock(const std::string& raw, size_t count) {
+        ByteReader r(raw);
+        std::vector<std::string> customers(r.getVarint());
+        for (auto& c : customers) c = r.getString();
+        std::vector<std::string> products(r.getVarint());
+        for (auto& p : products) p = r.getString();
+        size_t itemTotal = r.getVarint();
+        
+        std::vector<ArchivedOrder> orders(count);
+        int64_t id = 0, date = 0;
+        for (auto& o : orders) {
+            id += r.getSigned();
+            o.orderId = static_cast<int>(id);
+        }
+        for (auto& o : orders) {
+            date += r.getSigned();
+            o.orderDate = static_cast<time_t>(date);
+        }
+        for (auto& o : orders) {
+            o.totalAmount = r.getCents();
+        }
+        
+        auto customerIds = r.getBitPacked(count);
+        auto itemCounts = r.getBitPacked(count);
+        auto productIds = r.getBitPacked(itemTotal);
+        auto quantities = r.getBitPacked(itemTotal);
+        
+        size_t item = 0;
+        for (size_t i = 0; i < count; i++) {
+            if (customerIds[i] >= customers.size() || item + itemCounts[i] > itemTotal) {
+                throw std::runtime_error("Corrupt archive block: index out of range");
+            }
+            orders[i].customerName = customers[customerIds[i]];
+            for (uint32_t k = 0; k < itemCounts[i]; k++, item++) {
+                if (productIds[item] >= products.size()) {
+                    throw std::runtime_error("Corrupt archive block: index out of range");
+                }
+                orders[i].items.push_back(ArchivedItem{products[productIds[item]],
+                    static_cast<int>(quantities[item]), r.getCents()});
+            }
+        }
+        return orders;
+    }
+    
+    template<typename Visitor>
+    void scanBlocks(size_t start, time_t from, time_t to, Visitor visit, ArchiveScanStats* stats) const {
+        std::ifstream file(filename, std::ios::binary);
+        if (!file.is_open()) {
+            return;
+        }
+        
+        size_t size = fileSize(file);
+        size_t pos = std::min(start, size);
+        file.seekg(static_cast<std::streamoff>(pos));
+        std::string headerBytes(headerSize, '\0');
+        while (pos + headerSize <= size && file.read(&headerBytes[0], headerSize)) {
+            ByteReader header(headerBytes);
+            if (header.getFixed(4) != blockMagic) {
+                throw std::runtime_error("Corrupt archive: bad block header in " + filename);
+            }
+            size_t count = header.getFixed(4);
+            time_t minDate = static_cast<time_t>(header.getFixed(8));
+            time_t maxDate = static_cast<time_t>(header.getFixed(8));
+            size_t rawSize = header.getFixed(4);
+            size_t storedSize = header.getFixed(4);
+            uint32_t expected = static_cast<uint32_t>(header.getFixed(4));
+            size_t end = pos + headerSize + storedSize;
+            if (end > size) {
+                break;
+            }
+            
+            std::string stored;
+            bool inRange = maxDate >= from && minDate <= to;
+            if (inRange || end == size) {
+                stored.assign(storedSize, '\0');
+                if (!file.read(&stored[0], storedSize) || checksum(stored) != expected) {
+                    if (end == size) {
+                        break;
+                    }
+                    throw std::runtime_error("Corrupt archive: bad block payload in " + filename);
+                }
+            } else {
+                file.seekg(storedSize, std::ios::cur);
+            }
+            
+            if (stats) {
+                stats->blocksTotal++;
+                stats->ordersTotal += count;
+                stats->rawBytes += rawSize;
+                stats->storedBytes += storedSize + headerSize;
+                stats->lastBlockOffset = pos;
+                stats->lastBlockChecksum = expected;
+            }
+            pos = end;
+            
+            if (!inRange) {
+                continue;
+            }
+            if (stats) {
+                stats->blocksScanned++;
+            }
+            
+            for (const auto& order : decodeBlock(BlockCompressor::decompress(stored, rawSize), count)) {
+                if (order.orderDate >= from && order.orderDate <= to) {
+                    visit(order);
+                }
+            }
+        }
+        
+        if (stats) {
+            stats->validBytes = pos;
+            stats->tornBytes = size - pos;
+        }
+    }
+    
+public:
+    OrderArchive(const std::string& file, size_t blockOrders = 4096)
+        : filename(file), ordersPerBlock(blockOrders) {}
+    
+    static uint32_t checksum(const std::string& data) {
+        uint32_t hash = 2166136261u;
+        for (unsigned char c : data) {
+            hash = (hash ^ c) * 16777619u;
+        }
+        return hash;
+    }
+    
+    const std::string& getFilename() const { return filename; }
+    
+    void append(const std::vector<ArchivedOrder>& orders) const {
+        size_t valid = validLength();
+        struct stat info;
+        if (stat(filename.c_str(), &info) == 0 && static_cast<size_t>(info.st_size) > valid &&
+            truncate(filename.c_str(), static_cast<off_t>(valid)) != 0) {
+            throw FileIOException(filename, "archive");
+        }
+        
+        std::ofstream file(filename, std::ios::binary | std::ios::app);
+        if (!file.is_open()) {
+            throw FileIOException(filename, "archive");
+        }
+        
+        for (size_t start = 0; start < orders.size(); start += ordersPerBlock) {
+            auto first = orders.begin() + start;
+            auto last = orders.begin() + std::min(orders.size(), start + ordersPerBlock);
+            
+            time_t minDate = first->orderDate, maxDate = first->orderDate;
+            for (auto it = first; it != last; ++it) {
+                minDate = std::min(minDate, it->orderDate);
+                maxDate = std::max(maxDate, it->orderDate);
+            }
+            
+            std::string raw = encodeBlock(first, last);
+            std::string stored = BlockCompressor::compress(raw);
+            
+            ByteWriter header;
+            header.putFixed(blockMagic, 4);
+            header.putFixed(static_cast<uint64_t>(last - first), 4);
+            header.putFixed(static_cast<uint64_t>(minDate), 8);
+            header.putFixed(static_cast<uint64_t>(maxDate), 8);
+            header.putFixed(raw.size(), 4);
+            header.putFixed(stored.size(), 4);
+            header.putFixed(checksum(stored), 4);
+            file << header.data() << stored;
+        }
+        
+        if (!file) {
+            throw FileIOException(filename, "archive");
+        }
+    }
+    
+    template<typename Visitor>
+    void scan(time_t from, time_t to, Visitor visit, ArchiveScanStats* stats = nullptr) const {
+        scanBlocks(0, from, to, visit, stats);
+    }
+    
+    template<typename Visitor>
+    void scanAfter(size_t offset, Visitor visit, ArchiveScanStats* stats = nullptr) const {
+        scanBlocks(offset, std::numeric_limits<time_t>::min(), std::numeric_limits<time_t>::max(), visit, stats);
+    }
+    
+    bool hasBlockEndingAt(size_t offset, uint32_t expected, size_t end) const {
+        if (end == 0) {
+            return true;
+        }
+        std::ifstream file(filename, std::ios::binary);
+        if (!file.is_open() || fileSize(file) < end) {
+            return false;
+        }
+        
+        std::string headerBytes(headerSize, '\0');
+        file.seekg(static_cast<std::streamoff>(offset));
+        if (!file.read(&headerBytes[0], headerSize)) {
+            return false;
+        }
+        ByteReader header(headerBytes);
+        if (header.getFixed(4) != blockMagic) {
+            return false;
+        }
+        header.getFixed(4);
+        header.getFixed(8);
+        header.getFixed(8);
+        header.getFixed(4);
+        size_t storedSize = header.getFixed(4);
+        return offset + headerSize + storedSize == end && header.getFixed(4) == expected;
+    }
+    
+    std::vector<ArchivedOrder> query(time_t from, time_t to, ArchiveScanStats* stats = nullptr) const {
+        std::vector<ArchivedOrder> result;
+        scan(from, to, [&result](const ArchivedOrder& order) { result.push_back(order); }, stats);
+        return result;
+    }
+};
+
+class ArchiveSummary {
+private:
+    static const uint32_t summaryMagic = 0x4d555341;
+    
+    std::string filename;
+    size_t archiveBytes;
+    size_t lastBlockOffset;
+    uint32_t lastBlockChecksum;
+    OrderIdRanges orderIds;
+    SalesCube sales;
+    std::vector<CustomerSummary> customers;
+    std::unordered_map<std::string, uint32_t> customerIndex;
+    
+    void decode(const std::string& body) {
+        ByteReader r(body, "archive summary");
+        archiveBytes = r.getVarint();
+        lastBlockOffset = r.getVarint();
+        lastBlockChecksum = static_cast<uint32_t>(r.getFixed(4));
+        
+        int64_t previous = 0;
+        for (size_t i = 0, n = r.getVarint(); i < n; i++) {
+            int64_t first = previous + r.getSigned();
+            int64_t last = first + static_cast<int64_t>(r.getVarint());
+            if (first < INT_MIN || last > INT_MAX || 
+                !orderIds.appendRange(static_cast<int>(first), static_cast<int>(last))) {
+                throw CorruptDataException("archive summary", "bad order ID range");
+            }
+            previous = last;
+        }
+        sales = SalesCube::decode(r);
+        
+        for (size_t i = 0, n = r.getVarint(); i < n; i++) {
+            CustomerSummary& customer = customerFor(r.getString());
+            customer.orderCount = static_cast<int>(r.getVarint());
+            customer.lifetimeSpend = r.getCents();
+            customer.lastOrderDate = static_cast<time_t>(r.getSigned());
+        }
+        if (!r.atEnd()) {
+            throw CorruptDataException("archive summary", "trailing data");
+        }
+    }
+    
+    CustomerSummary& customerFor(const std::string& name) {
+        auto it = customerIndex.find(name);
+        if (it != customerIndex.end()) {
+            return customers[it->second];
+        }
+        uint32_t id = static_cast<uint32_t>(customers.size());
+        customers.push_back(CustomerSummary{id, name, 0, 0, 0, {}});
+        customerIndex[name] = id;
+        return customers.back();
+    }
+    
+public:
+    explicit ArchiveSummary(const std::string& file) 
+        : filename(file), archiveBytes(0), lastBlockOffset(0), lastBlockChecksum(0) {}
+    
+    const std::string& getFilename() const { return filename; }
+    size_t getArchiveBytes() const { return archiveBytes; }
+    size_t getLastBlockOffset() const { return lastBlockOffset; }
+    uint32_t getLastBlockChecksum() const { return lastBlockChecksum; }
+    const OrderIdRanges& getOrderIds() const { return orderIds; }
+    const SalesCube& getSales() const { return sales; }
+    const std::vector<CustomerSummary>& getCustomers() const { return customers; }
+    
+    bool load() {
+        std::ifstream file(filename, std::ios::binary);
+        if (!file.is_open()) {
+            return false;
+        }
+        std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        
+        try {
+            ByteReader header(data, "archive summary");
+            if (header.getFixed(4) != summaryMagic) {
+                return false;
+            }
+            uint32_t expected = static_cast<uint32_t>(header.getFixed(4));
+            std::string body = data.substr(8);
+            if (OrderArchive::checksum(body) != expected) {
+                return false;
+            }
+            decode(body);
+            return true;
+        } catch (const CorruptDataException&) {
+            clear();
+            return false;
+        }
+    }
+    
+    void clear() {
+        *this = ArchiveSummary(filename);
+    }
+    
+    bool add(const ArchivedOrder& order, const std::vector<SaleLine>& lines) {
+        if (!orderIds.insert(order.orderId)) {
+            return false;
+        }
+        sales.recordOrder(order.orderDate, lines);
+        CustomerSummary& customer = customerFor(order.customerName);
+        customer.orderCount++;
+        customer.lifetimeSpend += order.totalAmount;
+        customer.lastOrderDate = std::max(customer.lastOrderDate, order.orderDate);
+        return true;
+    }
+    
+    void coverArchive(const ArchiveScanStats& stats) {
+        if (stats.blocksTotal > 0) {
+            lastBlockOffset = stats.lastBlockOffset;
+            lastBlockChecksum = stats.lastBlockChecksum;
+        }
+        archiveBytes = stats.validBytes;
+    }
+    
+    void save() const {
+        ByteWriter body;
+        body.putVarint(archiveBytes);
+        body.putVarint(lastBlockOffset);
+        body.putFixed(lastBlockChecksum, 4);
+        
+        body.putVarint(std::distance(orderIds.begin(), orderIds.end()));
+        int64_t previous = 0;
+        for (const auto& range : orderIds) {
+            body.putSigned(range.first - previous);
+            body.putVarint(static_cast<uint64_t>(range.second - range.first));
+            previous = range.second;
+        }
+        sales.encode(body);
+        
+        body.putVarint(customers.size());
+        for (const auto& customer : customers) {
+            body.putString(customer.name);
+            body.putVarint(static_cast<uint64_t>(customer.orderCount));
+            body.putCents(customer.lifetimeSpend);
+            body.putSigned(customer.lastOrderDate);
+        }
+        
+        ByteWriter header;
+        header.putFixed(summaryMagic, 4);
+        header.putFixed(OrderArchive::checksum(body.data()), 4);
+        AsyncFileWriter file(filename);
+        file.write(header.data());
+        file.write(body.data());
+        file.commit();
+    }
+};
+
+struct CompactProductRecord {
+    static const size_t idCapacity = 12;
+    
+    char id[idCapacity];
+    uint32_t nameOffset;
+    int32_t pricePaise;
+    int32_t stock;
+    uint16_t attributes[3];
+    uint16_t reorderPoint;
+    uint8_t leadTimeDays;
+    uint8_t typeAndFlags;
+    
+    enum : uint8_t {
+        TypeClothing = 0,
+        TypeStationery = 1,
+        TypeAccessory = 2,
+        TypeMask = 0x03,
+        FlagElectronic = 0x04
+    };
+    
+    std::string getId() const {
+        return std::string(id, strnlen(id, idCapacity));
+    }
+};
+
+class CompactCatalog {
+private:
+    std::vector<CompactProductRecord> records;
+    std::string namePool;
+    std::unordered_map<std::string, uint32_t> nameIndex;
+    std::vector<std::string> attributes;
+    std::unordered_map<std::string, uint16_t> attributeIndex;
+    bool sorted;
+    
+    uint16_t internAttribute(const std::string& value) {
+        auto it = attributeIndex.find(value);
+        if (it != attributeIndex.end()) {
+            return it->second;
+        }
+        if (attributes.size() > UINT16_MAX) {
+            throw std::length_error("Too many distinct attribute values for compact mode");
+        }
+        uint16_t id = static_cast<uint16_t>(attributes.size());
+        attributes.push_back(value);
+        attributeIndex[value] = id;
+        return id;
+    }
+    
+    uint32_t internName(const std::string& name) {
+        auto it = nameIndex.find(name);
+        if (it != nameIndex.end()) {
+            return it->second;
+        }
+        if (namePool.size() + name.size() + 1 > UINT32_MAX) {
+            throw std::length_error("Name pool exceeds compact mode capacity");
+        }
+        uint32_t offset = static_cast<uint32_t>(namePool.size());
+        namePool.append(name);
+        namePool.push_back('\0');
+        nameIndex[name] = offset;
+        return offset;
+    }
+    
+    static bool byId(const CompactProductRecord& a, const CompactProductRecord& b) {
+        return std::strncmp(a.id, b.id, CompactProductRecord::idCapacity) < 0;
+    }
+    
+public:
+    CompactCatalog() : sorted(true) {}
+    
+    void add(const std::string& csvLine) {
+        auto tokens = split(csvLine, ',');
+        if (tokens.size() < 7) {
+            throw std::invalid_argument("Malformed product record: " + csvLine);
+        }
+        
+        CompactProductRecord record;
+        std::memset(&record, 0, sizeof(record));
+        if (tokens[1].size() > CompactProductRecord::idCapacity) {
+            throw std::invalid_argument("Product ID too long for compact mode: " + tokens[1]);
+        }
+        std::memcpy(record.id, tokens[1].data(), tokens[1].size());
+        
+        double price = std::stod(tokens[3]);
+        if (price < 0 || price * 100 > INT32_MAX) {
+            throw InvalidPriceException(price);
+        }
+        record.nameOffset = internName(tokens[2]);
+        record.pricePaise = static_cast<int32_t>(price * 100 + 0.5);
+        record.stock = std::stoi(tokens[4]);
+        
+        size_t attributeCount;
+        if (tokens[0] == "Clothing") {
+            record.typeAndFlags = CompactProductRecord::TypeClothing;
+            attributeCount = 3;
+        } else if (tokens[0] == "Stationery") {
+            record.typeAndFlags = CompactProductRecord::TypeStationery;
+            attributeCount = 2;
+        } else if (tokens[0] == "Accessory") {
+            record.typeAndFlags = CompactProductRecord::TypeAccessory;
+            if (tokens[5] == "1") {
+                record.typeAndFlags |= CompactProductRecord::FlagElectronic;
+            }
+            tokens.erase(tokens.begin() + 5);
+            attributeCount = 1;
+        } else {
+            throw std::invalid_argument("Unknown product type: " + tokens[0]);
+        }
+        
+        if (tokens.size() < 5 + attributeCount) {
+            throw std::invalid_argument("Malformed product record: " + csvLine);
+        }
+        for (size_t i = 0; i < attributeCount; i++) {
+            record.attributes[i] = internAttribute(tokens[5 + i]);
+        }
+        
+        size_t reorderAt = 5 + attributeCount;
+        record.reorderPoint = 10;
+        record.leadTimeDays = 7;
+        if (tokens.size() >= reorderAt + 2) {
+            record.reorderPoint = static_cast<uint16_t>(std::min(std::stoi(tokens[reorderAt]), 
+                                                                 static_cast<int>(UINT16_MAX)));
+            record.leadTimeDays = static_cast<uint8_t>(std::min(std::stoi(tokens[reorderAt + 1]), 
+                                                                static_cast<int>(UINT8_MAX)));
+        }
+        
+        records.push_back(record);
+        sorted = false;
+    }
+    
+    template<typename T>
+    void addSnapshot(const InventorySnapshot<T>& view) {
+        for (const auto& record : view.getRecords()) {
+            add(record->csv);
+        }
+    }
+    
+    void loadFromFile(const std::string& filename) {
+        AsyncFileReader file(filename);
+        if (!file.isOpen()) {
+            throw FileIOException(filename, "load");
+        }
+        std::string line;
+        while (file.getline(line)) {
+            if (!line.empty() && line[0] != '#') {
+                add(line);
+            }
+        }
+        finalize();
+    }
+    
+    void finalize() {
+        if (!sorted) {
+            std::sort(records.begin(), records.end(), byId);
+            sorted = true;
+        }
+        records.shrink_to_fit();
+        namePool.shrink_to_fit();
+        std::unordered_map<std::string, uint32_t>().swap(nameIndex);
+    }
+    
+    const CompactProductRecord* find(const std::string& id) const {
+        if (!sorted || id.size() > CompactProductRecord::idCapacity) {
+            return nullptr;
+        }
+        CompactProductRecord key;
+        std::memset(key.id, 0, sizeof(key.id));
+        std::memcpy(key.id, id.data(), id.size());
+        auto it = std::lower_bound(records.begin(), records.end(), key, byId);
+        return it != records.end() && !byId(key, *it) ? &*it : nullptr;
+    }
+    
+    std::string nameOf(const CompactProductRecord& record) const {
+        return std::string(namePool.c_str() + record.nameOffset);
+    }
+    
+    std::string toCSV(const CompactProductRecord& record) const {
+        static const char* types[] = {"Clothing", "Stationery", "Accessory"};
+        uint8_t type = record.typeAndFlags & CompactProductRecord::TypeMask;
+        
+        std::stringstream ss;
+        ss << types[type] << "," << record.getId() << "," << nameOf(record) << ","
+           << record.pricePaise / 100.0 << "," << record.stock;
+        if (type == CompactProductRecord::TypeAccessory) {
+            ss << "," << ((record.typeAndFlags & CompactProductRecord::FlagElectronic) ? "1" : "0");
+        }
+        size_t attributeCount = type == CompactProductRecord::TypeClothing ? 3 :
+                                type == CompactProductRecord::TypeStationery ? 2 : 1;
+        for (size_t i = 0; i < attributeCount; i++) {
+            ss << "," << attributes[record.attributes[i]];
+        }
+        ss << "," << record.reorderPoint << "," << static_cast<int>(record.leadTimeDays);
+        return ss.str();
+    }
+    
+    size_t size() const { return records.size(); }
+    
+    double bytesPerProduct() const {
+        return records.empty() ? 0.0 : sizeof(CompactProductRecord) + 
+                                       static_cast<double>(namePool.size()) / records.size();
+    }
+    
+    size_t memoryFootprint() const {
+        size_t bytes = sizeof(*this) + records.capacity() * sizeof(CompactProductRecord) +
+                       namePool.capacity() + hashMapBytes(nameIndex) +
+                       attributes.capacity() * sizeof(std::string) + hashMapBytes(attributeIndex);
+        for (const auto& value : attributes) {
+            bytes += 2 * stringHeapBytes(value);
+        }
+        for (const auto& entry : nameIndex) {
+            bytes += stringHeapBytes(entry.first);
+        }
+        return bytes;
+    }
+};
+
+class InventoryStatistics {
+public:
+    template<typename T>
+    static void generateReport(const Inventory<T>& inventory) {
+        std::cout << "\n=== Inventory Statistics ===\n";
+        
+        auto view = inventory.snapshot();
+        const auto& records = view->getRecords();
+        typedef typename InventorySnapshot<T>::RecordPtr RecordPtr;
+        
+        if (records.empty()) {
+            std::cout << "No products in inventory.\n";
+            return;
+        }
+        
+        std::map<std::string, int> categoryCount;
+        for (const auto& r : records) {
+            categoryCount[r->category]++;
+        }
+        
+        std::cout << "Products by Category:\n";
+        for (const auto& pair : categoryCount) {
+            std::cout << "  " << pair.first << ": " << pair.second << " products\n";
+        }
+        
+        auto maxPriceIt = std::max_element(records.begin(), records.end(),
+            [](const RecordPtr& a, const RecordPtr& b) {
+                return a->price < b->price;
+            });
+        
+        if (maxPriceIt != records.end()) {
+            std::cout << "Most Expensive Product: " << (*maxPriceIt)->name 
+                      << " (Rs." << (*maxPriceIt)->price << ")\n";
+        }
+        
+        std::cout << "Total Products: " << Product::getTotalProducts() << "\n";
+        std::cout << "Total Stock Value: Rs." << view->getTotalValue() << "\n";
+        std::cout << "Total Stock Quantity: " << view->getTotalStock() << "\n";
+    }
+};
+
+struct PurchaseSuggestion {
+    std::string store;
+    std::string productId;
+    std::string productName;
+    int stock;
+    int reorderPoint;
+    int leadTimeDays;
+    int suggestedQuantity;
+    bool outOfStock;
+    time_t firstDetected;
+};
+
+class ReorderEngine {
+private:
+    BoundedEventQueue<StockEvent> events;
+    std::map<std::pair<std::string, std::string>, PurchaseSuggestion> pending;
+    
+public:
+    explicit ReorderEngine(size_t capacity = 4096) : events(capacity) {
+        Product::setStockEventQueue(&events);
+    }
+    
+    ~ReorderEngine() {
+        Product::setStockEventQueue(nullptr);
+    }
+    
+    ReorderEngine(const ReorderEngine&) = delete;
+    ReorderEngine& operator=(const ReorderEngine&) = delete;
+    
+    size_t drain(size_t maxBatch = 1024) {
+        size_t processed = 0;
+        StockEvent event;
+        
+        while (processed < maxBatch && events.tryPop(event)) {
+            processed++;
+            std::pair<std::string, std::string> key(event.store, event.productId);
+            auto it = pending.find(key);
+            if (it == pending.end()) {
+                it = pending.insert({key, PurchaseSuggestion{event.store, event.productId,
+                    event.productName, 0, 0, 0, 0, false, event.timestamp}}).first;
+            }
+            
+            PurchaseSuggestion& suggestion = it->second;
+            suggestion.stock = event.stock;
+            suggestion.reorderPoint = event.reorderPoint;
+            suggestion.leadTimeDays = event.leadTimeDays;
+            suggestion.outOfStock = suggestion.outOfStock || event.type == StockEventType::OutOfStock;
+            suggestion.suggestedQuantity = std::max(event.reorderPoint * 2 - event.stock,
+                                                    std::max(event.reorderPoint, 1));
+        }
+        return processed;
+    }
+    
+    std::vector<PurchaseSuggestion> takeSuggestions() {
+        drain(events.capacity());
+        std::vector<PurchaseSuggestion> result;
+        for (const auto& pair : pending) {
+            result.push_back(pair.second);
+        }
+        pending.clear();
+        
+        std::sort(result.begin(), result.end(),
+            [](const PurchaseSuggestion& a, const PurchaseSuggestion& b) {
+                if (a.outOfStock != b.outOfStock) {
+                    return a.outOfStock;
+                }
+                return a.leadTimeDays > b.leadTimeDays;
+            });
+        return result;
+    }
+    
+    size_t getDroppedEvents() const {
+        return events.getDropped();
     }
+};
+
+#ifdef __linux__
+struct StockProtocol {
+    static const uint32_t maxFrameBytes = 1 << 20;
     
-    double getTotalValue() const {
-        return std::accumulate(products.begin(), products.end(), 0.0,
-            [](double sum, const T& p) { return sum + (p->getPrice() * p->getStock()); });
+    enum Op : uint8_t {
+        Find = 1,
+        Stock = 2,
+        Order = 3,
+        Filter = 4
+    };
+    
+    enum Status : uint8_t {
+        Ok = 0,
+        NotFound = 1,
+        InsufficientStock = 2,
+        BadRequest = 3,
+        Failed = 4
+    };
+    
+    enum FilterMode : uint8_t {
+        ByCategory = 0,
+        ByPriceRange = 1,
+        AtReorderPoint = 2
+    };
+    
+    static void appendFrame(std::string& out, const std::string& payload) {
+        uint32_t length = static_cast<uint32_t>(payload.size());
+        for (int i = 0; i < 4; i++) {
+            out.push_back(static_cast<char>(length >> (8 * i)));
+        }
+        out += payload;
     }
     
-    const std::vector<T>& getAllProducts() const {
-        return products;
+    static bool nextFrame(const std::string& buffer, size_t& pos, std::string& frame) {
+        if (buffer.size() - pos < 4) {
+            return false;
+        }
+        uint32_t length = 0;
+        for (int i = 0; i < 4; i++) {
+            length |= static_cast<uint32_t>(static_cast<uint8_t>(buffer[pos + i])) << (8 * i);
+        }
+        if (length > maxFrameBytes) {
+            throw std::length_error("Frame exceeds " + std::to_string(maxFrameBytes) + " bytes");
+        }
+        if (buffer.size() - pos - 4 < length) {
+            return false;
+        }
+        frame.assign(buffer, pos + 4, length);
+        pos += 4 + length;
+        return true;
     }
+};
+
+class StockServer {
+public:
+    typedef std::function<StockProtocol::Status(uint8_t, ByteReader&, ByteWriter&)> Handler;
     
-    void saveToFile(const std::string& filename) const {
-        std::ofstream file(filename);
-        if (!file.is_open()) {
-            throw FileIOException(filename, "save");
+private:
+    static const uint64_t listenerKey = 0;
+    static const uint64_t wakeKey = 1;
+    static const size_t maxPendingOutput = 4 << 20;
+    static const size_t maxPendingInput = 4 << 20;
+    
+    struct Connection {
+        int fd;
+        std::string input;
+        std::string output;
+        bool inFlight;
+        bool peerClosed;
+        uint32_t events;
+    };
+    
+    struct Batch {
+        uint64_t connection;
+        std::vector<std::string> requests;
+        std::string responses;
+    };
+    
+    std::string socketPath;
+    Handler handler;
+    int listenFd;
+    int epollFd;
+    int wakeFd;
+    uint64_t nextConnection;
+    std::unordered_map<uint64_t, Connection> connections;
+    
+    std::deque<Batch> pending;
+    std::vector<Batch> completed;
+    std::mutex pendingMutex;
+    std::mutex completedMutex;
+    std::condition_variable pendingReady;
+    std::vector<std::thread> workers;
+    bool workersStopping;
+    std::atomic<bool> stopRequested;
+    std::atomic<uint64_t> requestsServed;
+    std::atomic<uint64_t> batchesServed;
+    
+    static StockServer* signalTarget;
+    
+    static void onSignal(int) {
+        if (signalTarget) {
+            signalTarget->requestStop();
+        }
+    }
+    
+    void wake() {
+        uint64_t one = 1;
+        ssize_t ignored = ::write(wakeFd, &one, sizeof(one));
+        (void)ignored;
+    }
+    
+    void watch(int fd, uint64_t key, uint32_t events, int operation) {
+        struct epoll_event event;
+        std::memset(&event, 0, sizeof(event));
+        event.events = events;
+        event.data.u64 = key;
+        if (epoll_ctl(epollFd, operation, fd, &event) < 0) {
+            throw SocketException("epoll_ctl");
+        }
+    }
+    
+    void workerLoop() {
+        std::unique_lock<std::mutex> lock(pendingMutex);
+        for (;;) {
+            pendingReady.wait(lock, [this]() { return !pending.empty() || workersStopping; });
+            if (pending.empty()) {
+                return;
+            }
+            Batch batch = std::move(pending.front());
+            pending.pop_front();
+            lock.unlock();
+            
+            for (const auto& request : batch.requests) {
+                StockProtocol::appendFrame(batch.responses, process(request));
+            }
+            requestsServed += batch.requests.size();
+            batchesServed++;
+            
+            {
+                std::lock_guard<std::mutex> done(completedMutex);
+                completed.push_back(std::move(batch));
+            }
+            wake();
+            lock.lock();
+        }
+    }
+    
+    std::string process(const std::string& request) {
+        ByteReader args(request, "request");
+        ByteWriter result;
+        ByteWriter response;
+        uint64_t requestId = 0;
+        uint8_t status;
+        try {
+            requestId = args.getVarint();
+            uint8_t op = args.getByte();
+            status = handler(op, args, result);
+        } catch (const CorruptDataException& e) {
+            status = StockProtocol::BadRequest;
+            result = ByteWriter();
+            result.putString(e.what());
+        } catch (const std::exception& e) {
+            status = StockProtocol::Failed;
+            result = ByteWriter();
+            result.putString(e.what());
+        }
+        response.putVarint(requestId);
+        response.putByte(status);
+        response.data() += result.data();
+        return response.data();
+    }
+    
+    void acceptConnections() {
+        for (;;) {
+            int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0) {
+                if (errno == EINTR) continue;
+                if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                    std::cerr << "Warning: accept failed: " << strerror(errno) << "\n";
+                }
+                return;
+            }
+            uint64_t key = nextConnection++;
+            connections[key] = Connection{fd, std::string(), std::string(), false, false, EPOLLIN | EPOLLRDHUP};
+            watch(fd, key, EPOLLIN | EPOLLRDHUP, EPOLL_CTL_ADD);
+        }
+    }
+    
+    void closeConnection(uint64_t key) {
+        auto it = connections.find(key);
+        if (it != connections.end()) {
+            close(it->second.fd);
+            connections.erase(it);
+        }
+    }
+    
+    bool readInput(Connection& connection) {
+        char chunk[64 * 1024];
+        while (connection.input.size() <= maxPendingInput) {
+            ssize_t n = recv(connection.fd, chunk, sizeof(chunk), 0);
+            if (n > 0) {
+                connection.input.append(chunk, static_cast<size_t>(n));
+            } else if (n == 0) {
+                connection.peerClosed = true;
+                return true;
+            } else if (errno == EINTR) {
+                continue;
+            } else {
+                return errno == EAGAIN || errno == EWOULDBLOCK;
+            }
+        }
+        return true;
+    }
+    
+    bool flushOutput(Connection& connection) {
+        size_t sent = 0;
+        while (sent < connection.output.size()) {
+            ssize_t n = send(connection.fd, connection.output.data() + sent, 
+                             connection.output.size() - sent, MSG_NOSIGNAL);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+                return false;
+            }
+            sent += static_cast<size_t>(n);
+        }
+        connection.output.erase(0, sent);
+        return true;
+    }
+    
+    bool backlogged(const Connection& connection) const {
+        return connection.output.size() > maxPendingOutput;
+    }
+    
+    bool readPaused(const Connection& connection) const {
+        return backlogged(connection) || connection.input.size() > maxPendingInput;
+    }
+    
+    void updateInterest(uint64_t key, Connection& connection) {
+        uint32_t events = 0;
+        if (!readPaused(connection)) {
+            events |= EPOLLIN | EPOLLRDHUP;
+        }
+        if (!connection.output.empty()) {
+            events |= EPOLLOUT;
+        }
+        if (events != connection.events) {
+            watch(connection.fd, key, events, EPOLL_CTL_MOD);
+            connection.events = events;
+        }
+    }
+    
+    bool dispatch(uint64_t key, Connection& connection) {
+        if (connection.inFlight || backlogged(connection)) {
+            return true;
+        }
+        
+        Batch batch;
+        batch.connection = key;
+        size_t pos = 0;
+        std::string frame;
+        try {
+            while (StockProtocol::nextFrame(connection.input, pos, frame)) {
+                batch.requests.push_back(frame);
+            }
+        } catch (const std::exception&) {
+            return false;
+        }
+        connection.input.erase(0, pos);
+        if (batch.requests.empty()) {
+            return true;
+        }
+        
+        connection.inFlight = true;
+        {
+            std::lock_guard<std::mutex> lock(pendingMutex);
+            pending.push_back(std::move(batch));
+        }
+        pendingReady.notify_one();
+        return true;
+    }
+    
+    bool finished(const Connection& connection) const {
+        return connection.peerClosed && !connection.inFlight && connection.output.empty();
+    }
+    
+    void serviceConnection(uint64_t key, uint32_t events) {
+        auto it = connections.find(key);
+        if (it == connections.end()) {
+            return;
+        }
+        Connection& connection = it->second;
+        
+        bool healthy = !(events & EPOLLERR);
+        if (healthy && !readPaused(connection) && (events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP))) {
+            healthy = readInput(connection);
+        }
+        if (healthy && (events & (EPOLLOUT | EPOLLHUP))) {
+            healthy = flushOutput(connection);
+        }
+        if (healthy) {
+            healthy = dispatch(key, connection);
+        }
+        if (!healthy || finished(connection)) {
+            closeConnection(key);
+        } else {
+            updateInterest(key, connection);
+        }
+    }
+    
+    void deliverResponses() {
+        uint64_t counter;
+        ssize_t ignored = ::read(wakeFd, &counter, sizeof(counter));
+        (void)ignored;
+        
+        std::vector<Batch> ready;
+        {
+            std::lock_guard<std::mutex> lock(completedMutex);
+            ready.swap(completed);
+        }
+        
+        for (auto& batch : ready) {
+            auto it = connections.find(batch.connection);
+            if (it == connections.end()) {
+                continue;
+            }
+            Connection& connection = it->second;
+            connection.inFlight = false;
+            connection.output += batch.responses;
+            bool healthy = flushOutput(connection) && dispatch(batch.connection, connection);
+            if (!healthy || finished(connection)) {
+                closeConnection(batch.connection);
+            } else {
+                updateInterest(batch.connection, connection);
+            }
+        }
+    }
+    
+    void closeDescriptors() {
+        if (listenFd >= 0) {
+            close(listenFd);
+            unlink(socketPath.c_str());
+            listenFd = -1;
+        }
+        if (epollFd >= 0) {
+            close(epollFd);
+            epollFd = -1;
+        }
+        if (wakeFd >= 0) {
+            close(wakeFd);
+            wakeFd = -1;
+        }
+    }
+    
+public:
+    StockServer(const std::string& path, size_t workerCount, Handler requestHandler)
+        : socketPath(path), handler(requestHandler), listenFd(-1), epollFd(-1), wakeFd(-1),
+          nextConnection(2), workersStopping(false), stopRequested(false), 
+          requestsServed(0), batchesServed(0) {
+        struct sockaddr_un address;
+        std::memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        if (path.empty() || path.size() >= sizeof(address.sun_path)) {
+            throw std::invalid_argument("Invalid socket path: " + path);
+        }
+        std::memcpy(address.sun_path, path.c_str(), path.size());
+        
+        try {
+            listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+            if (listenFd < 0) {
+                throw SocketException("socket");
+            }
+            unlink(path.c_str());
+            if (bind(listenFd, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) < 0) {
+                throw SocketException("bind " + path);
+            }
+            if (listen(listenFd, SOMAXCONN) < 0) {
+                throw SocketException("listen");
+            }
+            
+            epollFd = epoll_create1(EPOLL_CLOEXEC);
+            wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+            if (epollFd < 0 || wakeFd < 0) {
+                throw SocketException("epoll setup");
+            }
+            watch(listenFd, listenerKey, EPOLLIN, EPOLL_CTL_ADD);
+            watch(wakeFd, wakeKey, EPOLLIN, EPOLL_CTL_ADD);
+        } catch (...) {
+            closeDescriptors();
+            throw;
         }
         
-        for (const auto& product : products) {
-            file << product->toCSV() << "\n";
+        size_t count = std::max<size_t>(1, workerCount);
+        for (size_t i = 0; i < count; i++) {
+            workers.emplace_back(&StockServer::workerLoop, this);
         }
-        file.close();
     }
     
-    void loadFromFile(const std::string& filename) {
-        std::ifstream file(filename);
-        if (!file.is_open()) {
-            return;
+    ~StockServer() {
+        {
+            std::lock_guard<std::mutex> lock(pendingMutex);
+            workersStopping = true;
         }
-        
-        products.clear();
-        std::string line;
-        
-        while (std::getline(file, line)) {
-            if (line.empty()) continue;
-            
-            auto tokens = split(line, ',');
-            if (tokens.empty()) continue;
-            
-            std::string type = tokens[0];
-            Product* product = nullptr;
-            
-            if (type == "Clothing") {
-                product = new Clothing();
-            } else if (type == "Stationery") {
-                product = new Stationery();
-            } else if (type == "Accessory") {
-                product = new Accessory();
-            }
-            
-            if (product) {
-                product->fromCSV(line);
-                products.push_back(product);
-            }
+        pendingReady.notify_all();
+        for (auto& worker : workers) {
+            worker.join();
         }
-        file.close();
+        for (const auto& pair : connections) {
+            close(pair.second.fd);
+        }
+        closeDescriptors();
     }
-};
-
-class OrderItem {
-private:
-    Product* product;
-    int quantity;
-    double unitPrice;
     
-public:
-    OrderItem(Product* p, int qty) 
-        : product(p), quantity(qty), unitPrice(p->getPrice()) {}
+    StockServer(const StockServer&) = delete;
+    StockServer& operator=(const StockServer&) = delete;
     
-    double getTotal() const {
-        return unitPrice * quantity;
+    void requestStop() {
+        stopRequested = true;
+        wake();
     }
     
-    void display() const {
-        std::cout << product->getName() << " x " << quantity 
-                  << " @ Rs." << unitPrice 
-                  << " = Rs." << getTotal() << "\n";
+    void run() {
+        struct sigaction action, previousInt, previousTerm;
+        std::memset(&action, 0, sizeof(action));
+        action.sa_handler = &StockServer::onSignal;
+        sigemptyset(&action.sa_mask);
+        signalTarget = this;
+        sigaction(SIGINT, &action, &previousInt);
+        sigaction(SIGTERM, &action, &previousTerm);
+        
+        struct epoll_event events[128];
+        while (!stopRequested) {
+            int n = epoll_wait(epollFd, events, 128, -1);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                break;
+            }
+            for (int i = 0; i < n; i++) {
+                uint64_t key = events[i].data.u64;
+                if (key == listenerKey) {
+                    acceptConnections();
+                } else if (key == wakeKey) {
+                    deliverResponses();
+                } else {
+                    serviceConnection(key, events[i].events);
+                }
+            }
+        }
+        
+        sigaction(SIGINT, &previousInt, nullptr);
+        sigaction(SIGTERM, &previousTerm, nullptr);
+        signalTarget = nullptr;
     }
     
-    Product* getProduct() const { return product; }
-    int getQuantity() const { return quantity; }
-    
-    std::string toCSV() const {
-        std::stringstream ss;
-        ss << product->getId() << "," << quantity << "," << unitPrice;
-        return ss.str();
-    }
+    uint64_t getRequestsServed() const { return requestsServed.load(); }
+    uint64_t getBatchesServed() const { return batchesServed.load(); }
 };
 
-class Order {
+StockServer* StockServer::signalTarget = nullptr;
+
+class StockClient {
 private:
-    static int orderCounter;
-    int orderId;
-    std::string customerName;
-    std::vector<OrderItem> items;
-    double totalAmount;
-    time_t orderDate;
+    int fd;
+    std::string input;
+    size_t inputPos;
     
 public:
-    Order(const std::string& customer = "") 
-        : customerName(customer), totalAmount(0) {
-        orderId = ++orderCounter;
-        orderDate = time(nullptr);
-    }
-    
-    void addItem(Product* product, int quantity) {
-        if (quantity <= 0) {
-            throw std::invalid_argument("Quantity must be positive");
+    explicit StockClient(const std::string& path) : fd(-1), inputPos(0) {
+        struct sockaddr_un address;
+        std::memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        if (path.empty() || path.size() >= sizeof(address.sun_path)) {
+            throw std::invalid_argument("Invalid socket path: " + path);
         }
+        std::memcpy(address.sun_path, path.c_str(), path.size());
         
-        if (product->getStock() < quantity) {
-            throw InsufficientStockException(product->getName(), quantity, product->getStock());
+        fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd < 0) {
+            throw SocketException("socket");
+        }
+        if (connect(fd, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) < 0) {
+            close(fd);
+            throw SocketException("connect " + path);
         }
-        
-        items.emplace_back(product, quantity);
-        totalAmount += items.back().getTotal();
-        product->updateStock(-quantity);
     }
     
-    void display() const {
-        std::cout << "\n=== Order Details ===\n";
-        std::cout << "Order ID: " << orderId << "\n";
-        std::cout << "Customer: " << customerName << "\n";
-        std::cout << "Date: " << ctime(&orderDate);
-        std::cout << "\nItems:\n";
-        
-        for (const auto& item : items) {
-            std::cout << "  ";
-            item.display();
-        }
-        
-        std::cout << "\nTotal Amount: Rs." << totalAmount << "\n";
-        std::cout << "====================\n";
+    ~StockClient() {
+        close(fd);
     }
     
-    double getTotalAmount() const { return totalAmount; }
-    int getOrderId() const { return orderId; }
+    StockClient(const StockClient&) = delete;
+    StockClient& operator=(const StockClient&) = delete;
     
-    std::string toCSV() const {
-        std::stringstream ss;
-        ss << orderId << "," << customerName << "," << totalAmount << "," 
-           << orderDate << "," << items.size();
-        
-        for (const auto& item : items) {
-            ss << "," << item.toCSV();
+    static void appendRequest(std::string& out, uint64_t requestId, uint8_t op, const std::string& args) {
+        ByteWriter request;
+        request.putVarint(requestId);
+        request.putByte(op);
+        request.data() += args;
+        StockProtocol::appendFrame(out, request.data());
+    }
+    
+    void send(const std::string& frames) {
+        size_t sent = 0;
+        while (sent < frames.size()) {
+            ssize_t n = ::send(fd, frames.data() + sent, frames.size() - sent, MSG_NOSIGNAL);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                throw SocketException("send");
+            }
+            sent += static_cast<size_t>(n);
         }
-        
-        return ss.str();
     }
     
-    void fromCSV(const std::string& csvLine, Inventory<Product*>& inventory) {
-        auto tokens = split(csvLine, ',');
-        if (tokens.size() >= 5) {
-            orderId = std::stoi(tokens[0]);
-            customerName = tokens[1];
-            totalAmount = std::stod(tokens[2]);
-            orderDate = std::stol(tokens[3]);
-            int itemCount = std::stoi(tokens[4]);
-            
-            int index = 5;
-            for (int i = 0; i < itemCount; i++) {
-                if (index + 2 < tokens.size()) {
-                    std::string productId = tokens[index];
-                    int quantity = std::stoi(tokens[index + 1]);
-                    Product* product = inventory.findProduct(productId);
-                    if (product) {
-                        OrderItem item(product, quantity);
-                        items.push_back(item);
-                    }
-                    index += 3;
-                }
+    std::string receive() {
+        std::string frame;
+        while (!StockProtocol::nextFrame(input, inputPos, frame)) {
+            input.erase(0, inputPos);
+            inputPos = 0;
+            char chunk[64 * 1024];
+            ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+            if (n < 0 && errno == EINTR) {
+                continue;
             }
-            
-            if (orderId > orderCounter) {
-                orderCounter = orderId;
+            if (n <= 0) {
+                throw SocketException("recv");
             }
+            input.append(chunk, static_cast<size_t>(n));
         }
+        return frame;
     }
 };
 
-int Order::orderCounter = 1000;
-
-class InventoryStatistics {
-public:
-    template<typename T>
-    static void generateReport(const Inventory<T>& inventory) {
-        std::cout << "\n=== Inventory Statistics ===\n";
+class StockLoadGenerator {
+private:
+    std::string socketPath;
+    size_t connections;
+    double seconds;
+    size_t pipelineDepth;
+    
+    std::vector<std::string> fetchProductIds() {
+        StockClient client(socketPath);
+        ByteWriter args;
+        args.putVarint(0);
+        args.putByte(StockProtocol::ByPriceRange);
+        args.putSigned(0);
+        args.putSigned(std::numeric_limits<int64_t>::max() / 2);
         
-        const auto& products = inventory.getAllProducts();
+        std::string frame;
+        StockClient::appendRequest(frame, 0, StockProtocol::Filter, args.data());
+        client.send(frame);
+        std::string response = client.receive();
         
-        if (products.empty()) {
-            std::cout << "No products in inventory.\n";
-            return;
+        ByteReader reader(response, "response");
+        reader.getVarint();
+        if (reader.getByte() != StockProtocol::Ok) {
+            throw std::runtime_error("Server rejected the product listing request");
         }
-        
-        std::map<std::string, int> categoryCount;
-        for (const auto& p : products) {
-            categoryCount[p->getCategory()]++;
+        std::vector<std::string> ids(reader.getVarint());
+        for (auto& id : ids) {
+            id = reader.getString();
+            reader.getSigned();
         }
+        return ids;
+    }
+    
+    void runConnection(const std::vector<std::string>& ids, unsigned seed, 
+                       std::vector<uint32_t>& latencies, uint64_t& failures) {
+        typedef std::chrono::steady_clock Clock;
+        StockClient client(socketPath);
+        Clock::time_point deadline = Clock::now() + 
+            std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+        uint64_t nextId = 0;
         
-        std::cout << "Products by Category:\n";
-        for (const auto& pair : categoryCount) {
-            std::cout << "  " << pair.first << ": " << pair.second << " products\n";
+        while (Clock::now() < deadline) {
+            std::string frames;
+            for (size_t i = 0; i < pipelineDepth; i++) {
+                seed = seed * 1103515245u + 12345u;
+                ByteWriter args;
+                args.putVarint(0);
+                args.putString(ids[(seed >> 8) % ids.size()]);
+                uint8_t op = (seed >> 4) % 10 == 0 ? StockProtocol::Find : StockProtocol::Stock;
+                StockClient::appendRequest(frames, nextId + i, op, args.data());
+            }
+            
+            Clock::time_point start = Clock::now();
+            client.send(frames);
+            for (size_t i = 0; i < pipelineDepth; i++) {
+                std::string response = client.receive();
+                Clock::time_point now = Clock::now();
+                ByteReader reader(response, "response");
+                reader.getVarint();
+                if (reader.getByte() != StockProtocol::Ok) {
+                    failures++;
+                }
+                auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(now - start);
+                latencies.push_back(static_cast<uint32_t>(elapsed.count()));
+            }
+            nextId += pipelineDepth;
+        }
+    }
+    
+public:
+    StockLoadGenerator(const std::string& path, size_t connectionCount, double duration, size_t depth)
+        : socketPath(path), connections(std::max<size_t>(1, connectionCount)), 
+          seconds(duration), pipelineDepth(std::max<size_t>(1, depth)) {}
+    
+    void run() {
+        std::vector<std::string> ids = fetchProductIds();
+        if (ids.empty()) {
+            throw std::runtime_error("Server has no products to query");
         }
+        std::cout << "Load test: " << connections << " connections, pipeline depth " << pipelineDepth
+                  << ", " << seconds << "s against " << ids.size() << " products\n";
         
-        auto maxPriceIt = std::max_element(products.begin(), products.end(),
-            [](const T& a, const T& b) {
-                return a->getPrice() < b->getPrice();
+        std::vector<std::vector<uint32_t>> latencies(connections);
+        std::vector<uint64_t> failures(connections, 0);
+        std::vector<std::string> errors(connections);
+        std::vector<std::thread> threads;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < connections; i++) {
+            threads.emplace_back([this, &ids, &latencies, &failures, &errors, i]() {
+                try {
+                    runConnection(ids, static_cast<unsigned>(i * 7919 + 1), latencies[i], failures[i]);
+                } catch (const std::exception& e) {
+                    errors[i] = e.what();
+                }
             });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
         
-        if (maxPriceIt != products.end()) {
-            std::cout << "Most Expensive Product: " << (*maxPriceIt)->getName() 
-                      << " (Rs." << (*maxPriceIt)->getPrice() << ")\n";
+        std::vector<uint32_t> all;
+        uint64_t failed = 0;
+        for (size_t i = 0; i < connections; i++) {
+            all.insert(all.end(), latencies[i].begin(), latencies[i].end());
+            failed += failures[i];
+            if (!errors[i].empty()) {
+                std::cerr << "Connection " << i << " aborted: " << errors[i] << "\n";
+            }
+        }
+        if (all.empty()) {
+            std::cout << "No requests completed.\n";
+            return;
         }
+        std::sort(all.begin(), all.end());
         
-        std::cout << "Total Products: " << Product::getTotalProducts() << "\n";
-        std::cout << "Total Stock Value: Rs." << inventory.getTotalValue() << "\n";
-        std::cout << "Total Stock Quantity: " << inventory.getTotalStock() << "\n";
+        auto percentile = [&all](double p) {
+            return all[std::min(all.size() - 1, static_cast<size_t>(p * all.size()))];
+        };
+        std::cout << "Requests: " << all.size() << " (" << failed << " failed) in " << elapsed << "s\n";
+        std::cout << "Throughput: " << static_cast<uint64_t>(all.size() / elapsed) << " req/s\n";
+        std::cout << "Latency (us): p50 " << percentile(0.50) << " | p99 " << percentile(0.99)
+                  << " | p99.9 " << percentile(0.999) << " | max " << all.back() << "\n";
     }
 };
+#endif
 
 void displayProductDetails(const Product& p) {
     std::cout << "\n=== Detailed Product Information ===\n";
@@ -555,87 +4680,557 @@ void displayProductDetails(const Product& p) {
     std::cout << "Name: " << p.name << "\n";
     std::cout << "Category: " << p.category << "\n";
     std::cout << "Price: Rs." << p.price << "\n";
-    std::cout << "Current Stock: " << p.stock << "\n";
+    std::cout << "Current Stock: " << p.getStock() << "\n";
+    std::cout << "Reorder Point: " << p.getReorderPoint() << "\n";
+    std::cout << "Lead Time: " << p.getLeadTimeDays() << " days\n";
     std::cout << "===============================\n";
 }
 
 class iShopApp {
 private:
-    Inventory<Product*> mainInventory;
+    StoreNetwork<Product*> stores;
+    size_t activeStore;
     std::vector<Order> orders;
+    ReorderEngine reorderEngine;
+    SalesCube salesCube;
+    OrderArchive orderArchive;
+    OrderIdRanges archivedOrderIds;
+    bool ordersLoadFailed;
+    size_t unrecoveredOrders;
+    OrderJournal journal;
+    PersistenceService persistence;
+    std::mutex orderMutex;
     std::map<int, std::pair<std::string, void (iShopApp::*)()>> menuOptions;
     
-    void initializeMenu() {
-        menuOptions[1] = {"Add Product", &iShopApp::addProduct};
-        menuOptions[2] = {"Display Inventory", &iShopApp::displayInventory};
-        menuOptions[3] = {"Create Order", &iShopApp::createOrder};
-        menuOptions[4] = {"View Orders", &iShopApp::viewOrders};
-        menuOptions[5] = {"Generate Report", &iShopApp::generateReport};
-        menuOptions[6] = {"Filter Products", &iShopApp::filterProducts};
-        menuOptions[7] = {"Apply Discount", &iShopApp::applyDiscount};
-        menuOptions[8] = {"Save Data", &iShopApp::saveData};
-        menuOptions[9] = {"Load Data", &iShopApp::loadData};
-        menuOptions[10] = {"Exit", &iShopApp::exitApp};
+    void initializeMenu() {
+        menuOptions[1] = {"Add Product", &iShopApp::addProduct};
+        menuOptions[2] = {"Display Inventory", &iShopApp::displayInventory};
+        menuOptions[3] = {"Create Order", &iShopApp::createOrder};
+        menuOptions[4] = {"View Orders", &iShopApp::viewOrders};
+        menuOptions[5] = {"Generate Report", &iShopApp::generateReport};
+        menuOptions[6] = {"Filter Products", &iShopApp::filterProducts};
+        menuOptions[7] = {"Apply Discount", &iShopApp::applyDiscount};
+        menuOptions[8] = {"Save Data", &iShopApp::saveData};
+        menuOptions[9] = {"Load Data", &iShopApp::loadData};
+        menuOptions[10] = {"Manage Stores", &iShopApp::manageStores};
+        menuOptions[11] = {"Reorder Planning", &iShopApp::reorderPlanning};
+        menuOptions[12] = {"Sales Analytics", &iShopApp::salesAnalytics};
+        menuOptions[13] = {"Order Archive", &iShopApp::manageArchive};
+        menuOptions[14] = {"Customer Insights", &iShopApp::customerInsights};
+        menuOptions[15] = {"Memory Report", &iShopApp::memoryReport};
+        menuOptions[16] = {"Exit", &iShopApp::exitApp};
+    }
+    
+    Inventory<Product*>& currentStore() {
+        return stores.getStore(activeStore);
+    }
+    
+    void saveData() {
+        try {
+            if (unrecoveredOrders > 0) {
+                throw std::runtime_error("Not saving: " + std::to_string(unrecoveredOrders) + 
+                                         " journaled orders are not in the stock files yet; restart with --recover");
+            }
+            std::vector<std::string> skipped = stores.failedStores();
+            for (const auto& name : skipped) {
+                std::cerr << "Not saving store " << name << ": its data file failed to load.\n";
+            }
+            std::unique_lock<std::mutex> lock(orderMutex);
+            std::function<void()> saveStores = stores.prepareSave(Order::lastOrderId());
+            std::function<void()> saveOrders = prepareOrdersSave("orders.txt");
+            std::shared_ptr<const OrderIdRanges> saved = std::make_shared<const OrderIdRanges>(knownOrderIds());
+            uint32_t checkpoint = journal.rotate();
+            lock.unlock();
+            OrderJournal* orderJournal = &journal;
+            bool complete = skipped.empty();
+            persistence.submit("Save data", [saveStores, saveOrders, saved, checkpoint, orderJournal, complete]() {
+                saveStores();
+                saveOrders();
+                if (complete) {
+                    orderJournal->discardCovered(checkpoint, *saved);
+                }
+            });
+            std::cout << "Data save queued; writing in the background.\n";
+        } catch (const std::exception& e) {
+            std::cerr << "Error saving data: " << e.what() << "\n";
+        }
+    }
+    
+    void loadData() {
+        persistence.waitIdle();
+        std::vector<std::string> errors = stores.loadAll();
+        for (Inventory<Product*>* shard : stores.shards()) {
+            Order::observeOrderId(shard->getStockCheckpoint());
+        }
+        loadStep(errors, [this]() { loadOrdersFromFile("orders.txt"); });
+        loadStep(errors, [this]() { loadArchivedSales(); });
+        loadStep(errors, [this]() { checkJournal(); });
+        
+        for (const auto& error : errors) {
+            std::cerr << "Error loading data: " << error << "\n";
+        }
+        if (errors.empty()) {
+            std::cout << "Data loaded successfully!\n";
+        }
+    }
+    
+    static void loadStep(std::vector<std::string>& errors, const std::function<void()>& step) {
+        try {
+            step();
+        } catch (const std::exception& e) {
+            errors.push_back(e.what());
+        }
+    }
+    
+    std::function<void()> prepareOrdersSave(const std::string& filename) const {
+        if (ordersLoadFailed) {
+            throw std::runtime_error("Not saving orders: " + filename + " failed to load");
+        }
+        std::shared_ptr<const std::vector<Order>> pending = std::make_shared<const std::vector<Order>>(orders);
+        return [pending, filename]() {
+            AsyncFileWriter file(filename);
+            for (const auto& order : *pending) {
+                file.writeLine(order.toCSV());
+            }
+            file.commit();
+        };
+    }
+    
+    void saveOrdersToFile(const std::string& filename) {
+        persistence.submit("Save orders", prepareOrdersSave(filename));
+    }
+    
+    void recordOrderAggregates(const Order& order) {
+        salesCube.recordOrder(order);
+        CustomerRegistry::instance().recordOrder(order.getCustomerId(), order.getOrderId(),
+                                                 order.getTotalAmount(), order.getOrderDate());
+    }
+    
+    void syncArchiveSummary(ArchiveSummary& summary) {
+        bool loaded = summary.load();
+        bool current = loaded && orderArchive.hasBlockEndingAt(summary.getLastBlockOffset(), 
+                                                               summary.getLastBlockChecksum(),
+                                                               summary.getArchiveBytes());
+        if (!current) {
+            summary.clear();
+        }
+        
+        ArchiveScanStats stats;
+        orderArchive.scanAfter(summary.getArchiveBytes(), [this, &summary](const ArchivedOrder& order) {
+            std::vector<SaleLine> lines;
+            for (const auto& item : order.items) {
+                Product* product = stores.findProduct(item.productId);
+                lines.push_back(SaleLine{item.productId, product ? product->getCategory() : "Unknown",
+                                         item.quantity, item.unitPrice});
+            }
+            summary.add(order, lines);
+        }, &stats);
+        
+        if (stats.tornBytes > 0) {
+            std::cout << "Ignoring " << stats.tornBytes << " bytes of incomplete data at the end of "
+                      << orderArchive.getFilename() << ".\n";
+        }
+        if (stats.blocksTotal == 0 && current == loaded) {
+            return;
+        }
+        summary.coverArchive(stats);
+        try {
+            summary.save();
+        } catch (const std::exception& e) {
+            std::cerr << "Warning: " << e.what() << "; the archive will be read again on the next load.\n";
+        }
+    }
+    
+    void loadArchivedSales() {
+        salesCube.clear();
+        CustomerRegistry::instance().resetAggregates();
+        archivedOrderIds = OrderIdRanges();
+        
+        ArchiveSummary summary(orderArchive.getFilename() + ".summary");
+        std::string error;
+        try {
+            syncArchiveSummary(summary);
+        } catch (const std::exception& e) {
+            error = e.what();
+        }
+        archivedOrderIds = summary.getOrderIds();
+        salesCube.merge(summary.getSales());
+        for (const auto& customer : summary.getCustomers()) {
+            CustomerRegistry::instance().mergeTotals(customer);
+        }
+        Order::observeOrderId(archivedOrderIds.last());
+        
+        size_t before = orders.size();
+        orders.erase(std::remove_if(orders.begin(), orders.end(), [this](const Order& order) {
+            return archivedOrderIds.count(order.getOrderId()) > 0;
+        }), orders.end());
+        if (orders.size() != before) {
+            std::cout << before - orders.size() << " orders in orders.txt were already archived; "
+                      << "they will be dropped from it on the next save.\n";
+        }
+        for (const auto& order : orders) {
+            recordOrderAggregates(order);
+        }
+        if (!error.empty()) {
+            throw std::runtime_error(error);
+        }
+    }
+    
+    static bool parseDate(const std::string& text, time_t& result) {
+        std::tm date = {};
+        char dash1, dash2;
+        std::istringstream ss(text);
+        if (!(ss >> date.tm_year >> dash1 >> date.tm_mon >> dash2 >> date.tm_mday) ||
+            dash1 != '-' || dash2 != '-') {
+            return false;
+        }
+        date.tm_year -= 1900;
+        date.tm_mon -= 1;
+        date.tm_isdst = -1;
+        result = mktime(&date);
+        return result != -1;
+    }
+    
+    void loadOrdersFromFile(const std::string& filename) {
+        ordersLoadFailed = true;
+        AsyncFileReader file(filename);
+        if (!file.isOpen()) {
+            ordersLoadFailed = false;
+            return;
+        }
+        
+        orders.clear();
+        std::string line;
+        
+        while (file.getline(line)) {
+            if (line.empty()) continue;
+            
+            Order order(0, "", 0);
+            if (!order.fromCSV(line, stores)) {
+                std::cerr << "Skipping malformed order record: " << line << "\n";
+                continue;
+            }
+            orders.push_back(order);
+        }
+        ordersLoadFailed = false;
+    }
+    
+    OrderIdRanges knownOrderIds() const {
+        OrderIdRanges known(archivedOrderIds);
+        for (const auto& order : orders) {
+            known.insert(order.getOrderId());
+        }
+        return known;
+    }
+    
+    void checkJournal() {
+        OrderIdRanges known = knownOrderIds();
+        size_t unapplied = 0;
+        unrecoveredOrders = 0;
+        for (const auto& segment : journal.scan(false)) {
+            reportDamage(segment);
+            for (const auto& order : segment.afterDamage) {
+                Order::observeOrderId(order.orderId);
+            }
+            for (const auto& order : segment.orders) {
+                Order::observeOrderId(order.orderId);
+                int index = stores.indexOf(order.store);
+                int checkpoint = index >= 0 ? stores.getStore(static_cast<size_t>(index)).getStockCheckpoint() : -1;
+                bool listed = known.count(order.orderId) > 0;
+                bool stockApplied = checkpoint >= 0 ? order.orderId <= checkpoint : listed;
+                unapplied += listed && stockApplied ? 0 : 1;
+                unrecoveredOrders += stockApplied ? 0 : 1;
+            }
+        }
+        if (unapplied > 0) {
+            std::cout << unapplied << " journaled orders are missing from orders.txt or the stock files; "
+                      << "restart with --recover to replay them. The order log is kept until then.\n";
+        }
+    }
+    
+    void reportDamage(const JournalSegment& segment) {
+        if (segment.isDamaged()) {
+            std::cerr << "Warning: " << segment.path << " has an unreadable record at byte " 
+                      << segment.validBytes << " followed by " << segment.afterDamage.size() 
+                      << " intact records; orders after it are not replayed and the file is kept.\n";
+        }
+    }
+    
+    void recoverOrders() {
+        std::cout << "\n=== Order Log Recovery ===\n";
+        std::vector<JournalSegment> segments;
+        try {
+            segments = journal.scan(true);
+        } catch (const std::exception& e) {
+            std::cerr << "Error scanning order log: " << e.what() << "\n";
+            return;
+        }
+        
+        std::vector<ParsedOrder> pending;
+        size_t records = 0, tornSegments = 0, truncatedBytes = 0;
+        for (const auto& segment : segments) {
+            reportDamage(segment);
+            records += segment.orders.size();
+            if (segment.isTorn()) {
+                tornSegments++;
+                truncatedBytes += segment.fileBytes - segment.validBytes;
+            }
+            pending.insert(pending.end(), segment.orders.begin(), segment.orders.end());
+        }
+        std::sort(pending.begin(), pending.end(),
+            [](const ParsedOrder& a, const ParsedOrder& b) { return a.orderId < b.orderId; });
+        
+        OrderIdRanges listed = knownOrderIds();
+        std::unordered_set<int> seen;
+        size_t replayed = 0, duplicates = 0, rejected = 0, restocked = 0;
+        
+        for (const auto& parsed : pending) {
+            if (!seen.insert(parsed.orderId).second) {
+                duplicates++;
+                continue;
+            }
+            Inventory<Product*>* store = nullptr;
+            if (!parsed.store.empty()) {
+                int index = stores.indexOf(parsed.store);
+                if (index < 0) {
+                    std::cerr << "Order " << parsed.orderId << " references unknown store "
+                              << parsed.store << "; not replayed.\n";
+                    rejected++;
+                    continue;
+                }
+                store = &stores.getStore(static_cast<size_t>(index));
+            }
+            
+            bool isListed = listed.count(parsed.orderId) > 0;
+            int checkpoint = store ? store->getStockCheckpoint() : -1;
+            bool stockApplied = checkpoint >= 0 ? parsed.orderId <= checkpoint : isListed;
+            if (isListed && stockApplied) {
+                duplicates++;
+                continue;
+            }
+            
+            std::vector<Product*> products;
+            bool resolved = true;
+            for (const auto& line : parsed.lines) {
+                Product* product = store ? store->findProduct(line.productId) : stores.findProduct(line.productId);
+                if (!product) {
+                    std::cerr << "Order " << parsed.orderId << " references unknown product "
+                              << line.productId << "; not replayed.\n";
+                    resolved = false;
+                    break;
+                }
+                products.push_back(product);
+            }
+            if (!resolved) {
+                rejected++;
+                continue;
+            }
+            
+            Order order(parsed.orderId, parsed.customerName, parsed.orderDate);
+            for (size_t i = 0; i < parsed.lines.size(); i++) {
+                const OrderLine& line = parsed.lines[i];
+                if (!stockApplied) {
+                    int available = products[i]->getStock();
+                    if (available < line.quantity) {
+                        std::cerr << "Order " << parsed.orderId << ": only " << available << " of "
+                                  << line.quantity << " x " << line.productId << " left in stock.\n";
+                    }
+                    products[i]->updateStock(-std::min(line.quantity, available));
+                }
+                order.restoreItem(products[i], line.quantity, line.unitPrice);
+            }
+            if (!stockApplied) {
+                restocked++;
+            }
+            if (isListed) {
+                continue;
+            }
+            
+            Order::observeOrderId(parsed.orderId);
+            listed.insert(parsed.orderId);
+            orders.push_back(order);
+            recordOrderAggregates(order);
+            replayed++;
+        }
+        
+        unrecoveredOrders = 0;
+        std::cout << "Segments: " << segments.size() << " | Records: " << records
+                  << " | Replayed: " << replayed << " | Stock applied: " << restocked
+                  << " | Already applied: " << duplicates << " | Rejected: " << rejected << "\n";
+        if (tornSegments > 0) {
+            std::cout << "Truncated " << truncatedBytes << " bytes of torn records from "
+                      << tornSegments << " segments.\n";
+        }
+        if (replayed > 0 || restocked > 0) {
+            std::cout << "Save data to checkpoint the recovered orders.\n";
+        }
+    }
+    
+public:
+    iShopApp() : stores("stores.txt"), activeStore(0), orderArchive("orders.archive"),
+                 ordersLoadFailed(false), unrecoveredOrders(0), journal("orders.journal.") {
+        stores.loadConfig("iShop - IBA Karachi", "products.txt");
+        initializeMenu();
     }
     
-    void saveData() {
-        try {
-            mainInventory.saveToFile("products.txt");
-            saveOrdersToFile("orders.txt");
-            std::cout << "Data saved successfully!\n";
-        } catch (const std::exception& e) {
-            std::cerr << "Error saving data: " << e.what() << "\n";
+#ifdef __linux__
+    StockProtocol::Status handleStockRequest(uint8_t op, ByteReader& args, ByteWriter& result) {
+        EpochGuard guard;
+        uint64_t storeIndex = args.getVarint();
+        if (storeIndex >= stores.size()) {
+            return StockProtocol::BadRequest;
+        }
+        Inventory<Product*>& store = stores.getStore(static_cast<size_t>(storeIndex));
+        switch (op) {
+            case StockProtocol::Find: {
+                Product* product = store.findProduct(args.getString());
+                if (!product) {
+                    return StockProtocol::NotFound;
+                }
+                result.putString(product->toCSV());
+                return StockProtocol::Ok;
+            }
+            case StockProtocol::Stock: {
+                Product* product = store.findProduct(args.getString());
+                if (!product) {
+                    return StockProtocol::NotFound;
+                }
+                result.putSigned(product->getStock());
+                return StockProtocol::Ok;
+            }
+            case StockProtocol::Order:
+                return placeRemoteOrder(store, args, result);
+            case StockProtocol::Filter:
+                return filterRemote(store, args, result);
+            default:
+                return StockProtocol::BadRequest;
         }
     }
     
-    void loadData() {
+    StockProtocol::Status placeRemoteOrder(Inventory<Product*>& store, ByteReader& args, ByteWriter& result) {
+        std::string customer = args.getString();
+        if (!Order::isValidCustomerName(customer)) {
+            return StockProtocol::BadRequest;
+        }
+        uint64_t lineCount = args.getVarint();
+        if (lineCount > args.remaining() / 2) {
+            return StockProtocol::BadRequest;
+        }
+        std::vector<std::pair<Product*, int>> lines(static_cast<size_t>(lineCount));
+        for (auto& line : lines) {
+            std::string productId = args.getString();
+            int64_t quantity = args.getSigned();
+            if (quantity <= 0 || quantity > INT_MAX) {
+                return StockProtocol::BadRequest;
+            }
+            line.first = store.findProduct(productId);
+            line.second = static_cast<int>(quantity);
+            if (!line.first) {
+                result.putString(productId);
+                return StockProtocol::NotFound;
+            }
+        }
+        if (lines.empty()) {
+            return StockProtocol::BadRequest;
+        }
+        
+        std::lock_guard<std::mutex> lock(orderMutex);
+        size_t reserved = 0;
         try {
-            mainInventory.loadFromFile("products.txt");
-            loadOrdersFromFile("orders.txt");
-            std::cout << "Data loaded successfully!\n";
-        } catch (const std::exception& e) {
-            std::cerr << "Error loading data: " << e.what() << "\n";
+            for (; reserved < lines.size(); reserved++) {
+                lines[reserved].first->updateStock(-lines[reserved].second);
+            }
+        } catch (const InsufficientStockException&) {
+            for (size_t i = 0; i < reserved; i++) {
+                lines[i].first->updateStock(lines[i].second);
+            }
+            result.putString(lines[reserved].first->getId());
+            result.putSigned(lines[reserved].first->getStock());
+            return StockProtocol::InsufficientStock;
         }
+        
+        Order order(customer);
+        for (const auto& line : lines) {
+            order.restoreItem(line.first, line.second, line.first->getPrice());
+        }
+        orders.push_back(order);
+        recordOrderAggregates(order);
+        journal.append(order, store.getName());
+        OrderJournal* orderJournal = &journal;
+        persistence.submit("", [orderJournal]() { orderJournal->sync(); });
+        
+        result.putVarint(static_cast<uint64_t>(order.getOrderId()));
+        result.putSigned(static_cast<int64_t>(order.getTotalAmount() * 100 + 0.5));
+        return StockProtocol::Ok;
     }
     
-    void saveOrdersToFile(const std::string& filename) const {
-        std::ofstream file(filename);
-        if (!file.is_open()) {
-            throw FileIOException(filename, "save");
+    StockProtocol::Status filterRemote(Inventory<Product*>& store, ByteReader& args, ByteWriter& result) {
+        std::vector<Product*> filtered;
+        switch (args.getByte()) {
+            case StockProtocol::ByCategory: {
+                std::string category = args.getString();
+                filtered = store.filterProducts(
+                    [&category](const Product* p) { return p->getCategory() == category; });
+                break;
+            }
+            case StockProtocol::ByPriceRange: {
+                double minPrice = args.getSigned() / 100.0;
+                double maxPrice = args.getSigned() / 100.0;
+                filtered = store.filterProducts(
+                    [minPrice, maxPrice](const Product* p) {
+                        return p->getPrice() >= minPrice && p->getPrice() <= maxPrice;
+                    });
+                break;
+            }
+            case StockProtocol::AtReorderPoint:
+                filtered = store.filterProducts(
+                    [](const Product* p) { return p->needsReorder(); });
+                break;
+            default:
+                return StockProtocol::BadRequest;
         }
         
-        for (const auto& order : orders) {
-            file << order.toCSV() << "\n";
+        result.putVarint(filtered.size());
+        for (const auto* p : filtered) {
+            result.putString(p->getId());
+            result.putSigned(p->getStock());
         }
-        file.close();
+        return StockProtocol::Ok;
     }
     
-    void loadOrdersFromFile(const std::string& filename) {
-        std::ifstream file(filename);
-        if (!file.is_open()) {
-            return;
+    void serve(const std::string& socketPath, size_t workerCount, bool recover = false) {
+        loadData();
+        if (recover) {
+            recoverOrders();
         }
-        
-        orders.clear();
-        std::string line;
-        
-        while (std::getline(file, line)) {
-            if (line.empty()) continue;
-            
-            Order order;
-            order.fromCSV(line, mainInventory);
-            orders.push_back(order);
+        {
+            StockServer server(socketPath, workerCount,
+                [this](uint8_t op, ByteReader& args, ByteWriter& result) {
+                    return handleStockRequest(op, args, result);
+                });
+            std::cout << "Serving stock queries for " << stores.size() << " stores on " << socketPath
+                      << " with " << workerCount << " workers (Ctrl+C to stop)\n";
+            server.run();
+            std::cout << "\nServed " << server.getRequestsServed() << " requests in "
+                      << server.getBatchesServed() << " batches\n";
         }
-        file.close();
+        
+        saveData();
+        persistence.waitIdle();
+        std::cout << persistence.getStatus() << "\n";
     }
+#endif
     
-public:
-    iShopApp() : mainInventory("iShop - IBA Karachi") {
-        initializeMenu();
+    void printMemoryReport() {
+        loadData();
+        memoryReport();
     }
     
-    void run() {
+    void run(bool recover = false) {
         loadData();
+        if (recover) {
+            recoverOrders();
+        }
         
         int choice;
         do {
@@ -644,7 +5239,8 @@ public:
             std::cin >> choice;
             
             if (menuOptions.find(choice) != menuOptions.end()) {
-                if (choice == 10) {
+                EpochGuard guard;
+                if (menuOptions[choice].second == &iShopApp::exitApp) {
                     (this->*menuOptions[choice].second)();
                     break;
                 } else {
@@ -665,6 +5261,11 @@ public:
         std::cout << "\n=================================\n";
         std::cout << "     iShop Inventory System\n";
         std::cout << "     IBA Karachi Merch Store\n";
+        std::cout << "     Store: " << currentStore().getName() << "\n";
+        std::string saveStatus = persistence.getStatus();
+        if (!saveStatus.empty()) {
+            std::cout << "     " << saveStatus << "\n";
+        }
         std::cout << "=================================\n";
         
         for (const auto& option : menuOptions) {
@@ -706,7 +5307,7 @@ public:
                     std::cout << "Enter Material: ";
                     std::cin >> material;
                     
-                    mainInventory.addProduct(new Clothing(id, name, price, stock, 
+                    currentStore().addProduct(new Clothing(id, name, price, stock, 
                                                           size, color, material));
                     break;
                 }
@@ -717,7 +5318,7 @@ public:
                     std::cout << "Enter Item Type: ";
                     std::cin >> itemType;
                     
-                    mainInventory.addProduct(new Stationery(id, name, price, stock, 
+                    currentStore().addProduct(new Stationery(id, name, price, stock, 
                                                             brand, itemType));
                     break;
                 }
@@ -729,7 +5330,7 @@ public:
                     std::cout << "Enter Accessory Type: ";
                     std::cin >> accessoryType;
                     
-                    mainInventory.addProduct(new Accessory(id, name, price, stock, 
+                    currentStore().addProduct(new Accessory(id, name, price, stock, 
                                                           (electronic == 'Y' || electronic == 'y'), 
                                                           accessoryType));
                     break;
@@ -747,8 +5348,12 @@ public:
     }
     
     void displayInventory() {
-        mainInventory.displayAll();
-        std::cout << "\nTotal Products in System: " << Product::getTotalProducts() << "\n";
+        try {
+            currentStore().displayAll();
+            std::cout << "\nTotal Products in System: " << Product::getTotalProducts() << "\n";
+        } catch (const std::exception& e) {
+            std::cerr << "Error displaying inventory: " << e.what() << "\n";
+        }
     }
     
     void createOrder() {
@@ -757,6 +5362,10 @@ public:
         std::cout << "Enter Customer Name: ";
         std::cin.ignore();
         std::getline(std::cin, customerName);
+        if (!Order::isValidCustomerName(customerName)) {
+            std::cerr << "Error: customer name cannot contain commas, tabs or line breaks.\n";
+            return;
+        }
         
         Order order(customerName);
         char addMore;
@@ -770,7 +5379,7 @@ public:
             std::cout << "Enter Quantity: ";
             std::cin >> quantity;
             
-            Product* product = mainInventory.findProduct(productId);
+            Product* product = currentStore().findProduct(productId);
             if (product) {
                 try {
                     order.addItem(product, quantity);
@@ -788,6 +5397,14 @@ public:
         } while (addMore == 'Y' || addMore == 'y');
         
         orders.push_back(order);
+        recordOrderAggregates(order);
+        try {
+            journal.append(order, currentStore().getName());
+            OrderJournal* orderJournal = &journal;
+            persistence.submit("", [orderJournal]() { orderJournal->sync(); });
+        } catch (const std::exception& e) {
+            std::cerr << "Warning: order not journaled: " << e.what() << "\n";
+        }
         order.display();
     }
     
@@ -804,12 +5421,16 @@ public:
     }
     
     void generateReport() {
-        InventoryStatistics::generateReport(mainInventory);
+        try {
+            InventoryStatistics::generateReport(currentStore());
+        } catch (const std::exception& e) {
+            std::cerr << "Error generating report: " << e.what() << "\n";
+        }
     }
     
     void filterProducts() {
         std::cout << "\n=== Filter Products ===\n";
-        std::cout << "1. By Category\n2. By Price Range\n3. Low Stock (<10)\n";
+        std::cout << "1. By Category\n2. By Price Range\n3. At or Below Reorder Point\n";
         std::cout << "Select filter option: ";
         
         int option;
@@ -823,7 +5444,7 @@ public:
                 std::cout << "Enter category (Clothing/Stationery/Accessory): ";
                 std::cin >> category;
                 
-                filtered = mainInventory.filterProducts(
+                filtered = currentStore().filterProducts(
                     [&category](Product* p) { 
                         return p->getCategory() == category; 
                     });
@@ -836,16 +5457,16 @@ public:
                 std::cout << "Enter maximum price: ";
                 std::cin >> maxPrice;
                 
-                filtered = mainInventory.filterProducts(
+                filtered = currentStore().filterProducts(
                     [minPrice, maxPrice](Product* p) { 
                         return p->getPrice() >= minPrice && p->getPrice() <= maxPrice; 
                     });
                 break;
             }
             case 3: {
-                filtered = mainInventory.filterProducts(
+                filtered = currentStore().filterProducts(
                     [](Product* p) { 
-                        return p->getStock() < 10; 
+                        return p->needsReorder(); 
                     });
                 break;
             }
@@ -876,7 +5497,7 @@ public:
         std::cout << "Enter Discount Percentage: ";
         std::cin >> discount;
         
-        Product* product = mainInventory.findProduct(productId);
+        Product* product = currentStore().findProduct(productId);
         if (product) {
             try {
                 double discountedPrice = product->calculateDiscountedPrice(discount);
@@ -891,6 +5512,406 @@ public:
         }
     }
     
+    void manageStores() {
+        std::cout << "\n=== Manage Stores ===\n";
+        std::cout << "1. List Stores\n2. Add Store\n3. Switch Active Store\n"
+                  << "4. Locate Product\n5. Transfer Stock\n6. Compact Active Store\n";
+        std::cout << "Select option: ";
+        
+        int option;
+        std::cin >> option;
+        
+        try {
+            switch(option) {
+                case 1: {
+                    for (size_t i = 0; i < stores.size(); i++) {
+                        const auto& store = stores.getStore(i);
+                        std::cout << i + 1 << ". " << store.getName()
+                                  << (i == activeStore ? " (active)" : "")
+                                  << " | File: " << stores.getDataFile(i)
+                                  << " | Stock: " << store.getTotalStock()
+                                  << " | Value: Rs." << store.getTotalValue() << "\n";
+                    }
+                    std::cout << "Global Stock: " << stores.getGlobalStock()
+                              << " | Global Value: Rs." << stores.getGlobalValue() << "\n";
+                    break;
+                }
+                case 2: {
+                    std::string name, dataFile;
+                    std::cout << "Enter Store Name: ";
+                    std::cin.ignore();
+                    std::getline(std::cin, name);
+                    std::cout << "Enter Data File: ";
+                    std::cin >> dataFile;
+                    
+                    stores.addStore(name, dataFile, true);
+                    std::cout << "Store added successfully with " 
+                              << stores.getStore(stores.size() - 1).getAllProducts().size() 
+                              << " products from " << dataFile << "!\n";
+                    break;
+                }
+                case 3: {
+                    size_t index;
+                    std::cout << "Enter store number: ";
+                    std::cin >> index;
+                    
+                    if (index >= 1 && index <= stores.size()) {
+                        activeStore = index - 1;
+                        std::cout << "Active store: " << currentStore().getName() << "\n";
+                    } else {
+                        std::cout << "Invalid store number.\n";
+                    }
+                    break;
+                }
+                case 4: {
+                    std::string productId;
+                    std::cout << "Enter Product ID: ";
+                    std::cin >> productId;
+                    
+                    auto locations = stores.locateProduct(productId);
+                    if (locations.empty()) {
+                        std::cout << "Product not stocked in any store.\n";
+                    }
+                    for (const auto& location : locations) {
+                        std::cout << "  " << location.first << ": " << location.second << " in stock\n";
+                    }
+                    break;
+                }
+                case 5: {
+                    size_t from, to;
+                    std::string productId;
+                    int quantity;
+                    std::cout << "Enter source store number: ";
+                    std::cin >> from;
+                    std::cout << "Enter destination store number: ";
+                    std::cin >> to;
+                    std::cout << "Enter Product ID: ";
+                    std::cin >> productId;
+                    std::cout << "Enter Quantity: ";
+                    std::cin >> quantity;
+                    
+                    stores.transferStock(from - 1, to - 1, productId, quantity);
+                    std::cout << "Stock transferred successfully!\n";
+                    break;
+                }
+                case 6: {
+                    currentStore().compact();
+                    std::cout << "Store compacted; " << ProductSlotTable::instance().liveCount()
+                              << " product handles remain valid.\n";
+                    break;
+                }
+                default:
+                    std::cout << "Invalid option.\n";
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Error managing stores: " << e.what() << "\n";
+        }
+    }
+    
+    void reorderPlanning() {
+        std::cout << "\n=== Reorder Planning ===\n";
+        std::cout << "1. View Purchase Suggestions\n2. Set Reorder Policy\n";
+        std::cout << "Select option: ";
+        
+        int option;
+        std::cin >> option;
+        
+        if (option == 1) {
+            auto suggestions = reorderEngine.takeSuggestions();
+            if (suggestions.empty()) {
+                std::cout << "No products crossed their reorder point.\n";
+            }
+            for (const auto& s : suggestions) {
+                time_t expected = time(nullptr) + static_cast<time_t>(s.leadTimeDays) * 86400;
+                std::cout << (s.outOfStock ? "[OUT] " : "[LOW] ") << s.store
+                          << " | " << s.productId
+                          << " | " << s.productName
+                          << " | Stock: " << s.stock << "/" << s.reorderPoint
+                          << " | Order: " << s.suggestedQuantity
+                          << " | Lead Time: " << s.leadTimeDays << " days"
+                          << " | Expected: " << ctime(&expected);
+            }
+            if (reorderEngine.getDroppedEvents() > 0) {
+                std::cout << "Warning: " << reorderEngine.getDroppedEvents()
+                          << " stock events were dropped; run the reorder point filter.\n";
+            }
+        } else if (option == 2) {
+            std::string productId;
+            int point, leadTime;
+            std::cout << "Enter Product ID: ";
+            std::cin >> productId;
+            std::cout << "Enter Reorder Point: ";
+            std::cin >> point;
+            std::cout << "Enter Lead Time (days): ";
+            std::cin >> leadTime;
+            
+            Product* product = currentStore().findProduct(productId);
+            if (product) {
+                try {
+                    product->setReorderPolicy(point, leadTime);
+                    std::cout << "Reorder policy updated.\n";
+                } catch (const std::exception& e) {
+                    std::cerr << "Error updating policy: " << e.what() << "\n";
+                }
+            } else {
+                std::cout << "Product not found.\n";
+            }
+        } else {
+            std::cout << "Invalid option.\n";
+        }
+    }
+    
+    void salesAnalytics() {
+        std::cout << "\n=== Sales Analytics ===\n";
+        if (salesCube.empty()) {
+            std::cout << "No sales recorded yet.\n";
+            return;
+        }
+        
+        int period;
+        std::cout << "Enter number of days to analyse (0 for all history): ";
+        std::cin >> period;
+        
+        time_t to = std::max(salesCube.lastSale(), time(nullptr));
+        time_t from = period > 0 ? to - static_cast<time_t>(period - 1) * 86400 
+                                 : salesCube.firstSale();
+        
+        SalesCell total = salesCube.totals(from, to);
+        std::cout << "Orders: " << total.orders << " | Units: " << total.units
+                  << " | Revenue: Rs." << total.revenue << "\n";
+        
+        std::cout << "\nRevenue by Category:\n";
+        for (const auto& pair : salesCube.revenueByCategory(from, to)) {
+            std::cout << "  " << pair.first << ": Rs." << pair.second.revenue
+                      << " (" << pair.second.units << " units, "
+                      << pair.second.orders << " orders)\n";
+        }
+        
+        std::cout << "\nBest Sellers:\n";
+        for (const auto& pair : salesCube.bestSellers(from, to, 5)) {
+            Product* product = stores.findProduct(pair.first);
+            std::cout << "  " << pair.first << " | " << (product ? product->getName() : "Unknown")
+                      << " | Units: " << pair.second.units
+                      << " | Revenue: Rs." << pair.second.revenue
+                      << " | Velocity: " << salesCube.salesVelocity(pair.first, from, to)
+                      << " units/day\n";
+        }
+    }
+    
+    void manageArchive() {
+        std::cout << "\n=== Order Archive ===\n";
+        std::cout << "1. Archive Closed Orders\n2. Query Archive by Date Range\n3. Archive Statistics\n";
+        std::cout << "Select option: ";
+        
+        int option;
+        std::cin >> option;
+        
+        try {
+            switch(option) {
+                case 1: {
+                    int age;
+                    std::cout << "Archive orders older than how many days? ";
+                    std::cin >> age;
+                    
+                    time_t cutoff = time(nullptr) - static_cast<time_t>(std::max(age, 0)) * 86400;
+                    std::vector<ArchivedOrder> closed;
+                    std::vector<Order> open;
+                    for (const auto& order : orders) {
+                        if (order.getOrderDate() < cutoff) {
+                            closed.push_back(ArchivedOrder::fromOrder(order));
+                        } else {
+                            open.push_back(order);
+                        }
+                    }
+                    
+                    if (closed.empty()) {
+                        std::cout << "No orders to archive.\n";
+                        break;
+                    }
+                    orderArchive.append(closed);
+                    for (const auto& order : closed) {
+                        archivedOrderIds.insert(order.orderId);
+                    }
+                    orders.swap(open);
+                    saveOrdersToFile("orders.txt");
+                    ArchiveSummary summary(orderArchive.getFilename() + ".summary");
+                    syncArchiveSummary(summary);
+                    std::cout << closed.size() << " orders moved to " << orderArchive.getFilename() << ".\n";
+                    break;
+                }
+                case 2: {
+                    std::string fromText, toText;
+                    time_t from, to;
+                    std::cout << "Enter start date (YYYY-MM-DD): ";
+                    std::cin >> fromText;
+                    std::cout << "Enter end date (YYYY-MM-DD): ";
+                    std::cin >> toText;
+                    
+                    if (!parseDate(fromText, from) || !parseDate(toText, to)) {
+                        std::cout << "Invalid date.\n";
+                        break;
+                    }
+                    
+                    ArchiveScanStats stats;
+                    auto found = orderArchive.query(from, to + 86399, &stats);
+                    for (const auto& order : found) {
+                        std::cout << "Order " << order.orderId << " | " << order.customerName
+                                  << " | Items: " << order.items.size()
+                                  << " | Total: Rs." << order.totalAmount
+                                  << " | Date: " << ctime(&order.orderDate);
+                    }
+                    std::cout << found.size() << " orders found; scanned " << stats.blocksScanned
+                              << " of " << stats.blocksTotal << " blocks.\n";
+                    break;
+                }
+                case 3: {
+                    ArchiveScanStats stats;
+                    orderArchive.scan(1, 0, [](const ArchivedOrder&) {}, &stats);
+                    std::cout << "Blocks: " << stats.blocksTotal
+                              << " | Orders: " << stats.ordersTotal
+                              << " | Encoded: " << stats.rawBytes << " bytes"
+                              << " | Stored: " << stats.storedBytes << " bytes\n";
+                    break;
+                }
+                default:
+                    std::cout << "Invalid option.\n";
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Error accessing archive: " << e.what() << "\n";
+        }
+    }
+    
+    void customerInsights() {
+        std::cout << "\n=== Customer Insights ===\n";
+        std::cout << "1. Top Customers\n2. Customer History\n";
+        std::cout << "Select option: ";
+        
+        int option;
+        std::cin >> option;
+        
+        if (option == 1) {
+            size_t count;
+            std::cout << "How many customers? ";
+            std::cin >> count;
+            
+            auto top = CustomerRegistry::instance().topCustomers(count);
+            if (top.empty()) {
+                std::cout << "No customer orders recorded yet.\n";
+            }
+            for (size_t i = 0; i < top.size(); i++) {
+                std::cout << i + 1 << ". " << top[i].name
+                          << " | Orders: " << top[i].orderCount
+                          << " | Lifetime Spend: Rs." << top[i].lifetimeSpend
+                          << " | Last Order: " << ctime(&top[i].lastOrderDate);
+            }
+        } else if (option == 2) {
+            std::string name;
+            std::cout << "Enter Customer Name: ";
+            std::cin.ignore();
+            std::getline(std::cin, name);
+            
+            CustomerSummary customer;
+            if (!CustomerRegistry::instance().find(name, customer) || customer.orderCount == 0) {
+                std::cout << "No orders found for " << name << ".\n";
+                return;
+            }
+            
+            std::vector<CustomerOrderEntry> history;
+            try {
+                orderArchive.scan(std::numeric_limits<time_t>::min(), std::numeric_limits<time_t>::max(),
+                    [&history, &name](const ArchivedOrder& order) {
+                        if (order.customerName == name) {
+                            history.push_back(CustomerOrderEntry{order.orderId, order.orderDate, order.totalAmount});
+                        }
+                    });
+            } catch (const std::exception& e) {
+                std::cerr << "Error reading archived orders: " << e.what() << "\n";
+            }
+            for (const auto& entry : customer.history) {
+                if (!archivedOrderIds.count(entry.orderId)) {
+                    history.push_back(entry);
+                }
+            }
+            
+            std::cout << customer.name << " | Orders: " << customer.orderCount
+                      << " | Lifetime Spend: Rs." << customer.lifetimeSpend << "\n";
+            for (const auto& entry : history) {
+                std::cout << "  Order " << entry.orderId << " | Rs." << entry.amount
+                          << " | " << ctime(&entry.orderDate);
+            }
+        } else {
+            std::cout << "Invalid option.\n";
+        }
+    }
+    
+    void memoryReport() {
+        struct Row {
+            size_t count;
+            size_t objectBytes;
+            size_t stringBytes;
+        };
+        std::map<std::string, Row> byType;
+        size_t indexBytes = 0, snapshotBytes = 0;
+        CompactCatalog compact;
+        std::string compactError;
+        
+        for (size_t i = 0; i < stores.size(); i++) {
+            const auto& store = stores.getStore(i);
+            for (const auto* p : store.getAllProducts()) {
+                Row& row = byType[p->getType()];
+                row.count++;
+                row.objectBytes += p->objectBytes();
+                row.stringBytes += p->stringHeap();
+            }
+            indexBytes += store.indexBytes();
+            snapshotBytes += store.snapshotCacheBytes();
+            try {
+                compact.addSnapshot(*store.snapshot());
+            } catch (const std::exception& e) {
+                compactError = e.what();
+            }
+        }
+        compact.finalize();
+        
+        size_t orderBytes = orders.capacity() * sizeof(Order);
+        for (const auto& order : orders) {
+            orderBytes += order.memoryFootprint() - sizeof(Order);
+        }
+        
+        std::cout << "\n=== Memory Report (approximate) ===\n";
+        size_t productCount = 0, productBytes = 0;
+        for (const auto& pair : byType) {
+            const Row& row = pair.second;
+            size_t total = row.objectBytes + row.stringBytes;
+            productCount += row.count;
+            productBytes += total;
+            std::cout << pair.first << ": " << row.count << " products | "
+                      << row.objectBytes << " object bytes + " << row.stringBytes << " string heap bytes"
+                      << " | " << (row.count ? total / row.count : 0) << " bytes/product\n";
+        }
+        
+        std::cout << "Product indexes: " << indexBytes << " bytes\n";
+        std::cout << "Product slot table: " << ProductSlotTable::instance().memoryFootprint() << " bytes\n";
+        std::cout << "Snapshot cache: " << snapshotBytes << " bytes\n";
+        std::cout << "Orders: " << orders.size() << " orders | " << orderBytes << " bytes\n";
+        std::cout << "Sales cube: " << salesCube.memoryFootprint() << " bytes\n";
+        std::cout << "Customer registry: " << CustomerRegistry::instance().memoryFootprint() << " bytes\n";
+        
+        if (!compactError.empty()) {
+            std::cout << "\nCompact record mode unavailable: " << compactError << "\n";
+            return;
+        }
+        std::cout << "\nCompact record mode: " << compact.size() << " products | "
+                  << compact.memoryFootprint() << " bytes (" << sizeof(CompactProductRecord)
+                  << "-byte records)\n";
+        if (productCount > 0) {
+            double perProduct = static_cast<double>(productBytes + indexBytes) / productCount;
+            double compactPerProduct = compact.bytesPerProduct();
+            std::cout << "Projected for 10M SKUs: " << perProduct * 1e7 / (1 << 30) << " GiB as objects, "
+                      << compactPerProduct * 1e7 / (1 << 30) << " GiB in compact mode\n";
+        }
+    }
+    
     void exitApp() {
         char choice;
         std::cout << "\nSave data before exiting? (Y/N): ";
@@ -898,24 +5919,125 @@ public:
         
         if (choice == 'Y' || choice == 'y') {
             saveData();
+            persistence.waitIdle();
+            std::cout << persistence.getStatus() << "\n";
         }
         
         std::cout << "\nThank you for using iShop Inventory System!\n";
         std::cout << "IBA Karachi Merch Store - See you again!\n";
     }
+};
+
+int runCompactCatalog(const std::string& filename) {
+    CompactCatalog catalog;
+    catalog.loadFromFile(filename);
+    std::cout << "Loaded " << catalog.size() << " products from " << filename << " in compact mode: "
+              << catalog.memoryFootprint() << " bytes ("
+              << (catalog.size() ? catalog.memoryFootprint() / catalog.size() : 0) << " bytes/product)\n";
     
-    ~iShopApp() {
-        const auto& products = mainInventory.getAllProducts();
-        for (auto p : products) {
-            delete p;
-        }
+    std::string id;
+    while (std::cin >> id) {
+        const CompactProductRecord* record = catalog.find(id);
+        std::cout << (record ? catalog.toCSV(*record) : "Product not found.") << "\n";
     }
-};
+    return 0;
+}
+
+size_t parseCountOption(const std::string& option, const std::string& value) {
+    size_t used = 0;
+    unsigned long count = 0;
+    try {
+        count = value.find('-') == std::string::npos ? std::stoul(value, &used) : 0;
+    } catch (const std::logic_error&) {}
+    if (used != value.size() || count == 0) {
+        throw std::invalid_argument(option + " expects a positive whole number, got '" + value + "'");
+    }
+    return count;
+}
+
+double parseSecondsOption(const std::string& option, const std::string& value) {
+    size_t used = 0;
+    double seconds = 0;
+    try {
+        seconds = std::stod(value, &used);
+    } catch (const std::logic_error&) {}
+    if (used != value.size() || !(seconds > 0)) {
+        throw std::invalid_argument(option + " expects a positive number of seconds, got '" + value + "'");
+    }
+    return seconds;
+}
 
-int main() {
+int main(int argc, char* argv[]) {
+    bool recover = false;
+    bool reportMemory = false;
+    bool serve = false;
+    bool loadgen = false;
+    std::string compactFile;
+    std::string socketPath = "ishop.sock";
+    size_t workers = std::max(1u, std::thread::hardware_concurrency());
+    size_t connections = 4;
+    size_t pipeline = 16;
+    double duration = 5.0;
+    try {
+        for (int i = 1; i < argc; i++) {
+            std::string arg = argv[i];
+            bool hasValue = i + 1 < argc;
+            if (arg == "--recover") {
+                recover = true;
+            } else if (arg == "--memory-report") {
+                reportMemory = true;
+            } else if (arg == "--compact-catalog" && hasValue) {
+                compactFile = argv[++i];
+            } else if (arg == "--serve") {
+                serve = true;
+            } else if (arg == "--loadgen") {
+                loadgen = true;
+            } else if (arg == "--socket" && hasValue) {
+                socketPath = argv[++i];
+            } else if (arg == "--workers" && hasValue) {
+                workers = parseCountOption(arg, argv[++i]);
+            } else if (arg == "--connections" && hasValue) {
+                connections = parseCountOption(arg, argv[++i]);
+            } else if (arg == "--pipeline" && hasValue) {
+                pipeline = parseCountOption(arg, argv[++i]);
+            } else if (arg == "--duration" && hasValue) {
+                duration = parseSecondsOption(arg, argv[++i]);
+            }
+        }
+    } catch (const std::invalid_argument& e) {
+        std::cerr << "Usage error: " << e.what() << "\n";
+        return 1;
+    }
+    
     try {
+        if (!compactFile.empty()) {
+            return runCompactCatalog(compactFile);
+        }
+        
+#ifdef __linux__
+        if (loadgen) {
+            StockLoadGenerator(socketPath, connections, duration, pipeline).run();
+            return 0;
+        }
+#else
+        if (serve || loadgen) {
+            std::cerr << "The stock query server requires Linux.\n";
+            return 1;
+        }
+#endif
+        
         iShopApp app;
-        app.run();
+        if (reportMemory) {
+            app.printMemoryReport();
+            return 0;
+        }
+#ifdef __linux__
+        if (serve) {
+            app.serve(socketPath, workers, recover);
+            return 0;
+        }
+#endif
+        app.run(recover);
     } catch (const std::exception& e) {
         std::cerr << "Fatal error: " << e.what() << "\n";
         return 1;